@@ -0,0 +1,643 @@
+//
+//  main.cpp
+//  carl-bench
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+///
+/// Throughput benchmark for populating, serializing and deserializing synthetic object graphs.
+///
+/// Usage: carl-bench [--json] [--scale <factor>] [--iterations <count>] [--threads <count>] [--workload <name>]
+///
+/// Workloads: wide_pod, deep_list, inheritance, large_arrays, string_heavy. --threads 0 uses every hardware thread.
+///
+/// For every workload and format the populate, serialize and deserialize phases are timed (best
+/// of all iterations). Binary data is also scanned without creating any objects (see
+/// StreamScanner.h) and partially loaded, decoding only the last table entry and what it reaches
+/// (see PartialLoader.h). Phases are reported as ns/object and MB/s of serialized data, along with
+/// the number of heap allocations (and bytes) made by the last iteration of the phase and the peak
+/// resident set size of the process once the phase has run. The structural hash of each graph
+/// (populate included), a deep clone of it, a comparison against that clone and a streamed binary
+/// round trip (see ReflectedVariable::serializeStreaming()) are timed as well. With --json the
+/// results are written as a single JSON document which can be diffed between versions.
+/// When CARL is built with CARL_INSTRUMENTATION the per-type statistics collected over the whole
+/// run are reported as well.
+///
+
+#include "../carl.h"
+#include "../source/ReflectedVariable.h"
+#include "../source/PointerTable.h"
+#include "../source/ThreadPool.h"
+#include "../source/StreamScanner.h"
+#include "../source/PartialLoader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Allocation tracking ---------------------------------------------------------------------------
+
+namespace {
+
+std::atomic<size_t> g_allocationCount { 0 }; ///< Number of calls to operator new.
+std::atomic<size_t> g_allocationBytes { 0 }; ///< Number of bytes requested from operator new.
+
+} // namespace
+
+void *operator new(size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Workload types --------------------------------------------------------------------------------
+
+///
+/// A wide struct made up of nothing but plain old data.
+///
+struct WidePod {
+    CARL_DECLARE_REFLECTED_CLASS(WidePod);
+    int32_t  i0 = 0, i1 = 1, i2 = 2, i3 = 3, i4 = 4, i5 = 5, i6 = 6, i7 = 7;
+    float    f0 = 0, f1 = 1, f2 = 2, f3 = 3, f4 = 4, f5 = 5, f6 = 6, f7 = 7;
+    double   d0 = 0, d1 = 1, d2 = 2, d3 = 3;
+    uint64_t u0 = 0, u1 = 1, u2 = 2, u3 = 3;
+};
+
+CARL_REFLECT_CLASS(WidePod) {
+    CARL_REFLECT_MEMBER(i0); CARL_REFLECT_MEMBER(i1); CARL_REFLECT_MEMBER(i2); CARL_REFLECT_MEMBER(i3);
+    CARL_REFLECT_MEMBER(i4); CARL_REFLECT_MEMBER(i5); CARL_REFLECT_MEMBER(i6); CARL_REFLECT_MEMBER(i7);
+    CARL_REFLECT_MEMBER(f0); CARL_REFLECT_MEMBER(f1); CARL_REFLECT_MEMBER(f2); CARL_REFLECT_MEMBER(f3);
+    CARL_REFLECT_MEMBER(f4); CARL_REFLECT_MEMBER(f5); CARL_REFLECT_MEMBER(f6); CARL_REFLECT_MEMBER(f7);
+    CARL_REFLECT_MEMBER(d0); CARL_REFLECT_MEMBER(d1); CARL_REFLECT_MEMBER(d2); CARL_REFLECT_MEMBER(d3);
+    CARL_REFLECT_MEMBER(u0); CARL_REFLECT_MEMBER(u1); CARL_REFLECT_MEMBER(u2); CARL_REFLECT_MEMBER(u3);
+}
+
+///
+/// A block of wide structs, blocks are chained together to scale the workload.
+///
+struct WidePodBlock {
+    CARL_DECLARE_REFLECTED_CLASS(WidePodBlock);
+    WidePod       items[256];
+    WidePodBlock *next = nullptr;
+};
+
+CARL_REFLECT_CLASS(WidePodBlock) {
+    CARL_REFLECT_MEMBER(items);
+    CARL_REFLECT_MEMBER(next);
+}
+
+///
+/// A node of a singly linked list.
+///
+struct ListNode {
+    CARL_DECLARE_REFLECTED_CLASS(ListNode);
+    int64_t   value = 0;
+    ListNode *next = nullptr;
+};
+
+CARL_REFLECT_CLASS(ListNode) {
+    CARL_REFLECT_MEMBER(value);
+    CARL_REFLECT_MEMBER(next);
+}
+
+///
+/// An inheritance chain four types deep.
+///
+struct Entity {
+    CARL_DECLARE_REFLECTED_CLASS(Entity);
+    uint32_t id = 0;
+    uint32_t flags = 0;
+};
+
+CARL_REFLECT_CLASS(Entity) {
+    CARL_REFLECT_MEMBER(id);
+    CARL_REFLECT_MEMBER(flags);
+}
+
+struct SpatialEntity : public Entity {
+    CARL_DECLARE_REFLECTED_CLASS(SpatialEntity);
+    float position[3] = { 0, 0, 0 };
+};
+
+CARL_REFLECT_CLASS(SpatialEntity) {
+    CARL_DECLARE_PARENT(SpatialEntity, Entity);
+    CARL_REFLECT_MEMBER(position);
+}
+
+struct RenderEntity : public SpatialEntity {
+    CARL_DECLARE_REFLECTED_CLASS(RenderEntity);
+    float color[4] = { 1, 1, 1, 1 };
+    int   material = 0;
+};
+
+CARL_REFLECT_CLASS(RenderEntity) {
+    CARL_DECLARE_PARENT(RenderEntity, SpatialEntity);
+    CARL_REFLECT_MEMBER(color);
+    CARL_REFLECT_MEMBER(material);
+}
+
+struct Actor : public RenderEntity {
+    CARL_DECLARE_REFLECTED_CLASS(Actor);
+    double health = 100.0;
+    Actor *target = nullptr;
+    Actor *next = nullptr;
+};
+
+CARL_REFLECT_CLASS(Actor) {
+    CARL_DECLARE_PARENT(Actor, RenderEntity);
+    CARL_REFLECT_MEMBER(health);
+    CARL_REFLECT_MEMBER(target);
+    CARL_REFLECT_MEMBER(next);
+}
+
+///
+/// Large fixed size arrays of primitives.
+///
+struct Samples {
+    CARL_DECLARE_REFLECTED_CLASS(Samples);
+    float    values[4096];
+    uint32_t indices[4096];
+    Samples *next = nullptr;
+};
+
+CARL_REFLECT_CLASS(Samples) {
+    CARL_REFLECT_MEMBER(values);
+    CARL_REFLECT_MEMBER(indices);
+    CARL_REFLECT_MEMBER(next);
+}
+
+///
+/// A type made up mostly of strings.
+///
+struct Record {
+    CARL_DECLARE_REFLECTED_CLASS(Record);
+    std::string name;
+    std::string path;
+    std::string description;
+    std::string tags[4];
+    Record     *next = nullptr;
+};
+
+CARL_REFLECT_CLASS(Record) {
+    CARL_REFLECT_MEMBER(name);
+    CARL_REFLECT_MEMBER(path);
+    CARL_REFLECT_MEMBER(description);
+    CARL_REFLECT_MEMBER(tags);
+    CARL_REFLECT_MEMBER(next);
+}
+
+namespace {
+
+// Workloads -------------------------------------------------------------------------------------
+
+///
+/// A generated object graph. The objects stay alive until destroy() is called.
+///
+struct Graph
+{
+    carl::ReflectedVariable root;    ///< Root of the graph.
+    std::function<void()>   destroy; ///< Releases every object in the graph.
+};
+
+struct Workload
+{
+    const char *name;                          ///< Name used to select and report the workload.
+    size_t      baseCount;                     ///< Number of top level objects at a scale of 1.
+    std::function<Graph(size_t count)> build;  ///< Build a graph of 'count' top level objects.
+};
+
+///
+/// Link 'count' heap allocated objects together through their 'next' members.
+///
+template<class T, class Init>
+Graph buildList(size_t count, Init init)
+{
+    std::vector<T *> nodes(count);
+    for (size_t ii = 0; ii < count; ++ii) {
+        nodes[ii] = new T;
+        init(*nodes[ii], ii);
+    }
+    for (size_t ii = 0; ii + 1 < count; ++ii) {
+        nodes[ii]->next = nodes[ii + 1];
+    }
+
+    Graph graph;
+    graph.root = carl::ReflectedVariable(*nodes[0]);
+    graph.destroy = [nodes]() {
+        for (T *node : nodes) {
+            delete node;
+        }
+    };
+    return graph;
+}
+
+std::vector<Workload> workloads()
+{
+    std::vector<Workload> list;
+
+    list.push_back({ "wide_pod", 64, [](size_t count) {
+        return buildList<WidePodBlock>(count, [](WidePodBlock &block, size_t index) {
+            for (size_t ii = 0; ii < 256; ++ii) {
+                block.items[ii].i0 = static_cast<int32_t>(index);
+                block.items[ii].d3 = static_cast<double>(ii) * 0.5;
+            }
+        });
+    } });
+
+    list.push_back({ "deep_list", 100000, [](size_t count) {
+        return buildList<ListNode>(count, [](ListNode &node, size_t index) {
+            node.value = static_cast<int64_t>(index);
+        });
+    } });
+
+    list.push_back({ "inheritance", 50000, [](size_t count) {
+        Graph graph = buildList<Actor>(count, [](Actor &actor, size_t index) {
+            actor.id = static_cast<uint32_t>(index);
+            actor.position[1] = static_cast<float>(index);
+            actor.material = static_cast<int>(index % 16);
+        });
+
+        // Cross links between actors further down the list.
+        Actor *head = static_cast<Actor *>(const_cast<void *>(graph.root.instanceData()));
+        std::vector<Actor *> actors;
+        for (Actor *actor = head; actor != nullptr; actor = actor->next) {
+            actors.push_back(actor);
+        }
+        for (size_t ii = 0; ii < actors.size(); ++ii) {
+            actors[ii]->target = actors[(ii * 7 + 3) % actors.size()];
+        }
+        return graph;
+    } });
+
+    list.push_back({ "large_arrays", 64, [](size_t count) {
+        return buildList<Samples>(count, [](Samples &samples, size_t index) {
+            for (size_t ii = 0; ii < 4096; ++ii) {
+                samples.values[ii] = static_cast<float>(ii + index) * 0.25f;
+                samples.indices[ii] = static_cast<uint32_t>(ii ^ index);
+            }
+        });
+    } });
+
+    list.push_back({ "string_heavy", 20000, [](size_t count) {
+        return buildList<Record>(count, [](Record &record, size_t index) {
+            std::string id = std::to_string(index);
+            record.name = "record_" + id;
+            record.path = "/assets/records/group_" + std::to_string(index % 97) + "/record_" + id + ".dat";
+            record.description = "A moderately long description of record " + id + " which is long enough to avoid the small string optimization.";
+            for (size_t ii = 0; ii < 4; ++ii) {
+                record.tags[ii] = "tag" + std::to_string((index + ii) % 13);
+            }
+        });
+    } });
+
+    return list;
+}
+
+// Measurement -----------------------------------------------------------------------------------
+
+///
+/// Peak resident set size of the process (in kilobytes).
+///
+size_t peakResidentSetKB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize / 1024;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+struct Result
+{
+    std::string workload;
+    std::string format;
+    std::string phase;
+    size_t      objects = 0;          ///< Number of objects in the pointer table.
+    size_t      bytes = 0;            ///< Size of the serialized data.
+    double      seconds = 0.0;        ///< Best time over all iterations.
+    size_t      allocations = 0;      ///< Heap allocations made by the last iteration.
+    size_t      allocatedBytes = 0;   ///< Heap bytes requested by the last iteration.
+    size_t      peakRSSKB = 0;        ///< Peak RSS after the phase ran.
+
+    double nsPerObject() const { return objects ? seconds * 1e9 / static_cast<double>(objects) : 0.0; }
+    double mbPerSecond() const { return seconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0; }
+};
+
+///
+/// Time a phase over several iterations. 'setup' runs before and 'teardown' after each iteration, untimed.
+///
+void measure(Result &result, size_t iterations, const std::function<void()> &setup, const std::function<void()> &phase, const std::function<void()> &teardown)
+{
+    result.seconds = 0.0;
+    for (size_t ii = 0; ii < iterations; ++ii) {
+        setup();
+
+        size_t allocationCount = g_allocationCount.load();
+        size_t allocationBytes = g_allocationBytes.load();
+        auto start = std::chrono::steady_clock::now();
+        phase();
+        auto end = std::chrono::steady_clock::now();
+        result.allocations = g_allocationCount.load() - allocationCount;
+        result.allocatedBytes = g_allocationBytes.load() - allocationBytes;
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (ii == 0 || seconds < result.seconds) {
+            result.seconds = seconds;
+        }
+
+        teardown();
+    }
+
+    result.peakRSSKB = peakResidentSetKB();
+}
+
+void printJson(const std::vector<Result> &results, const carl::ReflectionDataManager::Statistics &statistics, double scale, size_t iterations, size_t threads)
+{
+    std::cout << "{\n";
+    std::cout << "  \"benchmark\": \"carl-bench\",\n";
+    std::cout << "  \"scale\": " << scale << ",\n";
+    std::cout << "  \"iterations\": " << iterations << ",\n";
+    std::cout << "  \"threads\": " << threads << ",\n";
+    std::cout << "  \"results\": [\n";
+    for (size_t ii = 0; ii < results.size(); ++ii) {
+        const Result &result = results[ii];
+        std::cout << "    { \"workload\": \"" << result.workload << "\", \"format\": \"" << result.format
+                  << "\", \"phase\": \"" << result.phase << "\", \"objects\": " << result.objects
+                  << ", \"bytes\": " << result.bytes << ", \"seconds\": " << result.seconds
+                  << ", \"ns_per_object\": " << result.nsPerObject() << ", \"mb_per_s\": " << result.mbPerSecond()
+                  << ", \"allocations\": " << result.allocations << ", \"allocated_bytes\": " << result.allocatedBytes
+                  << ", \"peak_rss_kb\": " << result.peakRSSKB << " }" << (ii + 1 < results.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ],\n";
+    std::cout << "  \"types\": [\n";
+    for (size_t ii = 0; ii < statistics.size(); ++ii) {
+        const carl::TypeStatistics &type = statistics[ii];
+        std::cout << "    { \"name\": \"" << type.name << "\", \"objects_written\": " << type.objectsWritten
+                  << ", \"objects_read\": " << type.objectsRead << ", \"bytes_written\": " << type.bytesWritten
+                  << ", \"bytes_read\": " << type.bytesRead << ", \"serialize_ns\": " << type.serializeNanoseconds
+                  << ", \"deserialize_ns\": " << type.deserializeNanoseconds << " }" << (ii + 1 < statistics.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n";
+    std::cout << "}\n";
+}
+
+void printTable(const std::vector<Result> &results, const carl::ReflectionDataManager::Statistics &statistics)
+{
+    char line[256];
+    snprintf(line, sizeof(line), "%-14s %-8s %-12s %10s %12s %10s %10s %12s %12s\n",
+             "workload", "format", "phase", "objects", "bytes", "ns/object", "MB/s", "allocations", "peak RSS KB");
+    std::cout << line;
+    for (auto &result : results) {
+        snprintf(line, sizeof(line), "%-14s %-8s %-12s %10zu %12zu %10.1f %10.1f %12zu %12zu\n",
+                 result.workload.c_str(), result.format.c_str(), result.phase.c_str(), result.objects, result.bytes,
+                 result.nsPerObject(), result.mbPerSecond(), result.allocations, result.peakRSSKB);
+        std::cout << line;
+    }
+
+    // Only populated when built with CARL_INSTRUMENTATION.
+    if (!statistics.empty()) {
+        snprintf(line, sizeof(line), "\n%-20s %12s %12s %14s %14s %14s %14s\n",
+                 "type", "written", "read", "bytes written", "bytes read", "serialize ms", "deserialize ms");
+        std::cout << line;
+        for (auto &type : statistics) {
+            snprintf(line, sizeof(line), "%-20s %12llu %12llu %14llu %14llu %14.2f %14.2f\n", type.name.c_str(),
+                     (unsigned long long)type.objectsWritten, (unsigned long long)type.objectsRead,
+                     (unsigned long long)type.bytesWritten, (unsigned long long)type.bytesRead,
+                     type.serializeNanoseconds / 1e6, type.deserializeNanoseconds / 1e6);
+            std::cout << line;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bool json = false;
+    double scale = 1.0;
+    size_t iterations = 3;
+    size_t threads = 1;
+    std::string filter;
+
+    for (int ii = 1; ii < argc; ++ii) {
+        std::string argument = argv[ii];
+        bool hasValue = (ii + 1 < argc);
+        if (argument == "--json") {
+            json = true;
+        } else if (argument == "--scale" && hasValue) {
+            scale = std::atof(argv[++ii]);
+        } else if (argument == "--iterations" && hasValue) {
+            iterations = std::max(1, std::atoi(argv[++ii]));
+        } else if (argument == "--threads" && hasValue) {
+            threads = static_cast<size_t>(std::max(0, std::atoi(argv[++ii])));
+        } else if (argument == "--workload" && hasValue) {
+            filter = argv[++ii];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--json] [--scale <factor>] [--iterations <count>] [--threads <count>] [--workload <name>]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Types are all registered by now.
+    carl::ReflectionDataManager::instance().freeze();
+
+    // Only create a pool when asked to (0 uses every hardware thread), the default measures the single threaded paths.
+    std::unique_ptr<carl::ThreadPool> pool;
+    if (threads != 1) {
+        pool = std::make_unique<carl::ThreadPool>(threads);
+        threads = pool->threadCount();
+    }
+
+    const struct { const char *name; carl::SerializationFormat format; } formats[] = {
+        { "text",     carl::SerializationFormat::Text },
+        { "binary",   carl::SerializationFormat::Binary },
+        { "columnar", carl::SerializationFormat::Columnar },
+    };
+
+    std::vector<Result> results;
+    for (auto &workload : workloads()) {
+        if (!filter.empty() && filter != workload.name) {
+            continue;
+        }
+
+        size_t count = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(workload.baseCount) * scale));
+        Graph graph = workload.build(count);
+
+        for (auto &format : formats) {
+            Result result;
+            result.workload = workload.name;
+            result.format = format.name;
+
+            // Populate.
+            std::unique_ptr<carl::PointerTable> table;
+            result.phase = "populate";
+            measure(result, iterations,
+                    [&]() { table = std::make_unique<carl::PointerTable>(); },
+                    [&]() { table->populate(graph.root, true); },
+                    [&]() {});
+            result.objects = table->size();
+            results.push_back(result);
+
+            // Serialize.
+            std::string data;
+            std::unique_ptr<std::ostringstream> output;
+            result.phase = "serialize";
+            measure(result, iterations,
+                    [&]() { output = std::make_unique<std::ostringstream>(); },
+                    [&]() { table->serialize(*output, format.format, pool.get()); },
+                    [&]() { data = output->str(); });
+            result.bytes = data.size();
+            results.back().bytes = data.size();
+            results.push_back(result);
+
+            // Deserialize.
+            result.phase = "deserialize";
+            std::unique_ptr<std::istringstream> input;
+            std::unique_ptr<carl::PointerTable> loaded;
+            measure(result, iterations,
+                    [&]() {
+                        input = std::make_unique<std::istringstream>(data);
+                        loaded = std::make_unique<carl::PointerTable>();
+                    },
+                    [&]() { loaded->deserialize(*input, format.format, nullptr, pool.get()); },
+                    [&]() { loaded->clear(); });
+            results.push_back(result);
+
+            // Walk the binary data without creating any objects.
+            if (format.format == carl::SerializationFormat::Binary) {
+                result.phase = "scan";
+                carl::StreamScanner scanner;
+                carl::StreamVisitor visitor;
+                measure(result, iterations, []() {}, [&]() { scanner.scan(data.data(), data.size(), visitor); }, []() {});
+                results.push_back(result);
+
+                // Index every record but only decode the last table entry (and what it reaches).
+                result.phase = "partial";
+                carl::PartialLoader loader;
+                measure(result, iterations, []() {}, [&]() {
+                            loader.open(data.data(), data.size());
+                            loader.load(loader.table().size() - 1);
+                        },
+                        [&]() { loader.close(); });
+                results.push_back(result);
+            }
+        }
+
+        // Structural hash of the whole graph (populate included), no serialized data is produced.
+        Result result;
+        result.workload = workload.name;
+        result.format = "-";
+        result.phase = "hash";
+        uint64_t hash = 0;
+        measure(result, iterations, []() {}, [&]() { hash = graph.root.hash(); }, []() {});
+        (void)hash;
+        carl::PointerTable table;
+        table.populate(graph.root, true);
+        result.objects = table.size();
+        results.push_back(result);
+
+        // Deep clone of the populated graph, the copies are destroyed after each iteration.
+        result.phase = "clone";
+        std::unique_ptr<carl::PointerTable> copies;
+        measure(result, iterations,
+                [&]() { copies = std::make_unique<carl::PointerTable>(); },
+                [&]() { table.clone(*copies); },
+                [&]() { copies->clear(); });
+        results.push_back(result);
+
+        // Deep comparison of the graph against a copy of itself, which has to walk the entire graph.
+        result.phase = "equals";
+        carl::PointerTable copy;
+        table.clone(copy);
+        bool equal = false;
+        measure(result, iterations, []() {}, [&]() { equal = graph.root.equals(copy.pointer(0)); }, []() {});
+        copy.clear();
+        if (!equal) {
+            std::cerr << "The clone of " << workload.name << " does not compare equal" << std::endl;
+            return 1;
+        }
+        results.push_back(result);
+
+        // Streamed binary serialization (populate included). Chunks are counted and dropped so the peak RSS
+        // reflects the serializer alone.
+        result.format = "streamed";
+        result.phase = "serialize";
+        size_t streamedBytes = 0;
+        measure(result, iterations,
+                [&]() { streamedBytes = 0; },
+                [&]() { graph.root.serializeStreaming([&](const char *, size_t size) { streamedBytes += size; }); },
+                []() {});
+        result.bytes = streamedBytes;
+        results.push_back(result);
+
+        std::string streamed;
+        graph.root.serializeStreaming([&](const char *data, size_t size) { streamed.append(data, size); });
+        result.phase = "deserialize";
+        std::unique_ptr<std::istringstream> input;
+        std::unique_ptr<carl::PointerTable> loaded;
+        measure(result, iterations,
+                [&]() {
+                    input = std::make_unique<std::istringstream>(streamed);
+                    loaded = std::make_unique<carl::PointerTable>();
+                },
+                [&]() { loaded->deserialize(*input, carl::SerializationFormat::Binary); },
+                [&]() { loaded->clear(); });
+        results.push_back(result);
+
+        graph.destroy();
+    }
+
+    carl::ReflectionDataManager::Statistics statistics;
+    carl::ReflectionDataManager::instance().statistics(statistics);
+
+    if (json) {
+        printJson(results, statistics, scale, iterations, threads);
+    } else {
+        printTable(results, statistics);
+    }
+
+    return 0;
+}
@@ -10,6 +10,7 @@
 
 #include "source/ReflectionData.h"
 #include "source/QualifierRemover.h"
+#include "source/ReflectionContainers.h"
 
 ///
 /// Specify the macros and classes necessary to generate reflection
@@ -51,18 +52,27 @@
 /// of the macro CARL_REFLECT_CLASS.
 ///
 #define CARL_DECLARE_PARENT(classType, parentType) \
-	carl::ReflectionDataCreator<carl::QualifierRemover<classType>::type>::DeclareParent(&carl::ReflectionDataCreator<carl::QualifierRemover<parentType>::type>::instance());
+	carl::ReflectionDataCreator<carl::QualifierRemover<classType>::type>::declareParent(&carl::ReflectionDataCreator<carl::QualifierRemover<parentType>::type>::instance());
+
+///
+/// Declare a previous name of a member of the type specified by classType so that data written before
+/// the member was renamed can still be read. Must be called within the scope of the macro CARL_REFLECT_CLASS
+/// after the member has been reflected.
+///
+#define CARL_DECLARE_MEMBER_ALIAS(classType, memberName, previousName) \
+	carl::ReflectionDataCreator<carl::QualifierRemover<classType>::type>::addMemberAlias(#memberName, #previousName);
 
 ///
 /// Reflect a specific member of a class. This must be called within
-/// the scope of the macro CARL_REFLECT_CLASS.
+/// the scope of the macro CARL_REFLECT_CLASS. Members may also be
+/// std::vector, std::array or std::map (see ReflectionContainers.h).
 ///
 // sizeof(carl::QualifierRemover<std::remove_all_extents<decltype(nullCast()->memberName)>::type >::type)
 #define CARL_REFLECT_MEMBER(memberName) \
     addMember(#memberName, (size_t)(&(nullCast()->memberName)), \
               sizeof(nullCast()->memberName), \
 			  carl::QualifierRemover<decltype(nullCast()->memberName)>::IsPointer, \
-              &(carl::ReflectionDataCreator<carl::QualifierRemover<std::remove_all_extents<decltype(nullCast()->memberName)>::type >::type>::instance()));
+              carl::memberReflectionData<carl::QualifierRemover<std::remove_all_extents<decltype(nullCast()->memberName)>::type >::type>());
 
 ///
 /// Generate a unique name. Make use of CARL_UNIQUE_NAME, the other macros
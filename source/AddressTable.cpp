@@ -0,0 +1,53 @@
+//
+//  AddressTable.cpp
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#include "AddressTable.h"
+
+namespace carl {
+
+void AddressTable::reserve(size_t count)
+{
+	if (count * kMaxLoadDenominator > m_entries.size() * kMaxLoadNumerator) {
+		grow(count);
+	}
+}
+
+void AddressTable::clear()
+{
+	for (auto &entry : m_entries) {
+		entry = Entry();
+	}
+	m_size = 0;
+}
+
+void AddressTable::grow(size_t count)
+{
+	size_t capacity = 16;
+	while (count * kMaxLoadDenominator > capacity * kMaxLoadNumerator) {
+		capacity *= 2;
+	}
+	if (capacity <= m_entries.size()) {
+		capacity = m_entries.size() * 2;
+	}
+
+	std::vector<Entry> entries(capacity);
+	entries.swap(m_entries);
+	m_mask = capacity - 1;
+
+	for (auto &entry : entries) {
+		if (entry.type != nullptr) {
+			size_t slot = hash(entry.address, entry.type) & m_mask;
+			while (m_entries[slot].type != nullptr) {
+				slot = (slot + 1) & m_mask;
+			}
+			m_entries[slot] = entry;
+		}
+	}
+}
+
+} // namespace carl
@@ -0,0 +1,144 @@
+//
+//  AddressTable.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Flat, open-addressing hash map from (address, type) to a table index. Entries are stored
+/// inline in a single array and collisions are resolved with linear probing, so adding an
+/// object never allocates unless the table needs to grow.
+///
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace carl {
+
+// Forward declarations.
+class ReflectionData;
+
+class AddressTable
+{
+public:
+    AddressTable() = default;
+    ~AddressTable() = default;
+
+    using Index = size_t;
+
+    ///
+    /// Value returned by find() when an entry does not exist.
+    ///
+    static constexpr Index kNotFound = static_cast<Index>(-1);
+
+    ///
+    /// Find the index stored for an address and type.
+    ///
+    /// @param address Address of the object.
+    /// @param type Reflection data of the object. Reflection data is unique per type.
+    /// @return The stored index, kNotFound if there is no entry.
+    ///
+    inline Index find(size_t address, const ReflectionData *type) const
+    {
+        if (m_entries.empty()) {
+            return kNotFound;
+        }
+
+        for (size_t slot = hash(address, type) & m_mask; ; slot = (slot + 1) & m_mask) {
+            const Entry &entry = m_entries[slot];
+            if (entry.type == nullptr) {
+                return kNotFound;
+            }
+            if (entry.address == address && entry.type == type) {
+                return entry.index;
+            }
+        }
+    }
+
+    ///
+    /// Find the index stored for an address and type, adding 'index' if there is no entry yet.
+    ///
+    /// @param address Address of the object.
+    /// @param type Reflection data of the object. Must not be null.
+    /// @param index Index to store if no entry exists.
+    /// @param inserted Set to true if a new entry was added, false if one already existed.
+    /// @return The index stored for this address and type.
+    ///
+    inline Index insert(size_t address, const ReflectionData *type, Index index, bool &inserted)
+    {
+        if ((m_size + 1) * kMaxLoadDenominator > m_entries.size() * kMaxLoadNumerator) {
+            grow(m_size + 1);
+        }
+
+        for (size_t slot = hash(address, type) & m_mask; ; slot = (slot + 1) & m_mask) {
+            Entry &entry = m_entries[slot];
+            if (entry.type == nullptr) {
+                entry.address = address;
+                entry.type = type;
+                entry.index = index;
+                ++m_size;
+                inserted = true;
+                return index;
+            }
+            if (entry.address == address && entry.type == type) {
+                inserted = false;
+                return entry.index;
+            }
+        }
+    }
+
+    ///
+    /// Make room for at least 'count' entries without further growth.
+    ///
+    /// @param count Number of entries expected.
+    ///
+    void reserve(size_t count);
+
+    ///
+    /// Remove all entries (keeps the allocated storage).
+    ///
+    void clear();
+
+    inline size_t size() const { return m_size; }
+
+private:
+
+    struct Entry
+    {
+        size_t                address = 0;
+        const ReflectionData *type    = nullptr; ///< A null type marks an empty slot.
+        Index                 index   = 0;
+    };
+
+    // The table is kept at most 7/8ths full.
+    static constexpr size_t kMaxLoadNumerator   = 7;
+    static constexpr size_t kMaxLoadDenominator = 8;
+
+    ///
+    /// Mix the address and type into a well distributed hash (the low bits of addresses are mostly zero).
+    ///
+    static inline size_t hash(size_t address, const ReflectionData *type)
+    {
+        uint64_t key = static_cast<uint64_t>(address) ^ (reinterpret_cast<uint64_t>(type) * 0x9E3779B97F4A7C15ull);
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDull;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+
+    ///
+    /// Grow the table so that it can hold 'count' entries and re-insert the existing ones.
+    ///
+    void grow(size_t count);
+
+    std::vector<Entry> m_entries;  ///< Slots of the table, always a power of two in size.
+    size_t             m_mask = 0; ///< m_entries.size() - 1.
+    size_t             m_size = 0; ///< Number of occupied slots.
+};
+
+} // namespace carl
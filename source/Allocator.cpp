@@ -0,0 +1,32 @@
+//
+//  Allocator.cpp
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#include "Allocator.h"
+
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace carl {
+
+std::string_view Allocator::keepCharacters(std::string_view characters)
+{
+	// Strings are nodes of the set so their characters never move. Tables on different threads can
+	// share an allocator, so the pool is locked.
+	static std::mutex mutex;
+	static std::set<std::string, std::less<>> pool;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto iter = pool.find(characters);
+	if (iter == pool.end()) {
+		iter = pool.emplace(characters).first;
+	}
+	return *iter;
+}
+
+} // namespace carl
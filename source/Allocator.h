@@ -0,0 +1,87 @@
+//
+//  Allocator.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Interface used by the deserializer to create the objects of a deserialized graph. By default
+/// every object is allocated on its own with new (see HeapAllocator). An Arena can be used instead
+/// to place every object of a graph in a few large blocks and release them all at once, along with
+/// the characters of any std::string_view members.
+///
+
+#include "ReflectionData.h"
+
+#include <cstddef>
+#include <string_view>
+
+namespace carl {
+
+class Allocator
+{
+public:
+    virtual ~Allocator() = default;
+
+    ///
+    /// Hint that a number of objects are about to be created. Called once per deserialized table
+    /// with the size of the table (which is known from the stream) before any objects are created.
+    ///
+    /// @param objectCount Maximum number of objects which will be created.
+    /// @param byteCount Estimate of the total size of the objects (in bytes), 0 if unknown.
+    ///
+    virtual void reserve(size_t /*objectCount*/, size_t /*byteCount*/) {}
+
+    ///
+    /// Create a default constructed instance of a type.
+    ///
+    /// @param reflectionData Type of the instance to create.
+    /// @return The new instance.
+    ///
+    virtual void *createInstance(const ReflectionData *reflectionData) = 0;
+
+    ///
+    /// Destroy an instance previously created with createInstance().
+    ///
+    /// @param reflectionData Type of the instance.
+    /// @param instance Instance to destroy.
+    ///
+    virtual void destroyInstance(const ReflectionData *reflectionData, void *instance) = 0;
+
+    ///
+    /// Keep a copy of the characters of a std::string_view member read from memory which does not outlive
+    /// the deserialized objects. The copy must live at least as long as the objects created by this allocator.
+    /// By default the characters are interned in a pool shared by the whole process, which is never released:
+    /// objects created on the heap have no owner the characters could be released with.
+    ///
+    /// @param characters Characters to keep.
+    /// @return View of the kept copy.
+    ///
+    virtual std::string_view keepCharacters(std::string_view characters);
+};
+
+///
+/// Allocator which creates every object individually on the heap. Objects created by this allocator
+/// can also be released with ReflectionData::destroyInstance() (or delete).
+///
+class HeapAllocator : public Allocator
+{
+public:
+    void *createInstance(const ReflectionData *reflectionData) override { return reflectionData->allocateInstance(); }
+    void destroyInstance(const ReflectionData *reflectionData, void *instance) override { reflectionData->destroyInstance(instance); }
+
+    ///
+    /// Get the shared heap allocator used when no allocator is specified.
+    ///
+    static HeapAllocator &instance()
+    {
+        static HeapAllocator allocator;
+        return allocator;
+    }
+};
+
+} // namespace carl
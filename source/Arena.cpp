@@ -0,0 +1,110 @@
+//
+//  Arena.cpp
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#include "Arena.h"
+
+#include <assert.h>
+#include <cstdint>
+#include <cstring>
+
+namespace carl {
+
+Arena::Arena(size_t blockSize) :
+	m_blockSize(blockSize)
+{
+	assert(blockSize > 0);
+}
+
+Arena::~Arena()
+{
+	release();
+}
+
+void Arena::reserve(size_t objectCount, size_t byteCount)
+{
+	m_destructors.reserve(m_destructors.size() + objectCount);
+
+	// Make sure the whole graph fits in the current block so that it ends up contiguous.
+	if (byteCount > static_cast<size_t>(m_end - m_current)) {
+		addBlock(byteCount);
+	}
+}
+
+void *Arena::createInstance(const ReflectionData *reflectionData)
+{
+	void *instance = reflectionData->constructInstance(allocate(reflectionData->size(), reflectionData->alignment()));
+	if (!reflectionData->isTriviallyDestructible()) {
+		m_destructors.push_back({ reflectionData, instance });
+	}
+
+	return instance;
+}
+
+void *Arena::allocate(size_t size, size_t alignment)
+{
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	uintptr_t current = reinterpret_cast<uintptr_t>(m_current);
+	uintptr_t aligned = (current + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+	if (m_current == nullptr || aligned + size > reinterpret_cast<uintptr_t>(m_end)) {
+		addBlock(size + alignment);
+		current = reinterpret_cast<uintptr_t>(m_current);
+		aligned = (current + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+	}
+
+	m_bytesUsed += (aligned - current) + size;
+	m_current = reinterpret_cast<char *>(aligned + size);
+	return reinterpret_cast<void *>(aligned);
+}
+
+std::string_view Arena::keepCharacters(std::string_view characters)
+{
+	char *storage = static_cast<char *>(allocate(characters.size(), 1));
+	memcpy(storage, characters.data(), characters.size());
+	return std::string_view(storage, characters.size());
+}
+
+void Arena::release()
+{
+	// Destruct in reverse order of creation, just like objects on the stack.
+	for (auto iter = m_destructors.rbegin(); iter != m_destructors.rend(); ++iter) {
+		iter->reflectionData->destructInstance(iter->instance);
+	}
+	m_destructors.clear();
+
+	// Keep the largest block around for the next graph.
+	Block largest;
+	for (auto &block : m_blocks) {
+		if (block.size > largest.size) {
+			largest = std::move(block);
+		}
+	}
+	m_blocks.clear();
+
+	m_current = nullptr;
+	m_end = nullptr;
+	if (largest.size > 0) {
+		m_current = largest.memory.get();
+		m_end = m_current + largest.size;
+		m_blocks.push_back(std::move(largest));
+	}
+	m_bytesUsed = 0;
+}
+
+void Arena::addBlock(size_t size)
+{
+	Block block;
+	block.size = (size > m_blockSize) ? size : m_blockSize;
+	block.memory.reset(new char[block.size]);
+
+	m_current = block.memory.get();
+	m_end = m_current + block.size;
+	m_blocks.push_back(std::move(block));
+}
+
+} // namespace carl
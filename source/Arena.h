@@ -0,0 +1,104 @@
+//
+//  Arena.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Allocator which places objects one after another in large blocks of memory. Individual
+/// objects are never freed; instead the entire arena is released at once with release(),
+/// which runs the destructors of any objects that need it (in reverse creation order) and
+/// frees the blocks. Released arenas keep their largest block so that repeated load/release
+/// cycles of similarly sized graphs do not go back to the heap.
+///
+
+#include "Allocator.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace carl {
+
+class Arena : public Allocator
+{
+public:
+
+    ///
+    /// @param blockSize Minimum size (in bytes) of each block allocated by the arena.
+    ///
+    explicit Arena(size_t blockSize = 64 * 1024);
+    ~Arena();
+
+    // An arena owns the objects created in it and is not copyable.
+    Arena(const Arena &other) = delete;
+    Arena &operator=(const Arena &other) = delete;
+
+    void reserve(size_t objectCount, size_t byteCount) override;
+    void *createInstance(const ReflectionData *reflectionData) override;
+
+    ///
+    /// Objects are only released as part of release(), this does nothing.
+    ///
+    void destroyInstance(const ReflectionData * /*reflectionData*/, void * /*instance*/) override {}
+
+    ///
+    /// Characters are copied into the arena and released with it.
+    ///
+    std::string_view keepCharacters(std::string_view characters) override;
+
+    ///
+    /// Allocate raw memory from the arena.
+    ///
+    /// @param size Number of bytes to allocate.
+    /// @param alignment Alignment of the allocation (must be a power of two).
+    /// @return The allocated memory.
+    ///
+    void *allocate(size_t size, size_t alignment);
+
+    ///
+    /// Destroy every object created in the arena and release its memory.
+    ///
+    void release();
+
+    ///
+    /// Get the number of bytes handed out by the arena since it was last released.
+    ///
+    /// @return Number of bytes allocated (including alignment padding).
+    ///
+    inline size_t bytesUsed() const { return m_bytesUsed; }
+
+private:
+
+    ///
+    /// Allocate a new block large enough to hold at least 'size' bytes and make it current.
+    ///
+    /// @param size Minimum number of usable bytes in the block.
+    ///
+    void addBlock(size_t size);
+
+    struct Block
+    {
+        std::unique_ptr<char[]> memory; ///< Memory of the block.
+        size_t                  size = 0; ///< Size of the block (in bytes).
+    };
+
+    struct Destructor
+    {
+        const ReflectionData *reflectionData; ///< Type of the object.
+        void                 *instance;       ///< Object to destruct.
+    };
+
+    std::vector<Block>      m_blocks;      ///< Blocks allocated by the arena. The last block is the current one.
+    std::vector<Destructor> m_destructors; ///< Objects which need their destructor run on release.
+    char                   *m_current = nullptr; ///< Next free byte in the current block.
+    char                   *m_end = nullptr;     ///< End of the current block.
+    size_t                  m_blockSize;         ///< Minimum size of each block.
+    size_t                  m_bytesUsed = 0;     ///< Number of bytes handed out.
+};
+
+} // namespace carl
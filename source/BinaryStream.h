@@ -0,0 +1,335 @@
+//
+//  BinaryStream.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Helpers for reading and writing the binary serialization format. Binary data is
+/// always staged in memory so that records can be length-prefixed when written and
+/// decoded without rewinding the source stream when read.
+///
+/// Binary stream layout (all values are written with native byte order and width):
+///
+///   Header:  char[4] magic "CARL", uint32 version, uint32 byte order mark,
+///            uint64 table size, uint64 record count, uint32 type count,
+///            uint64 schema size (bytes of type entries that follow), then per type:
+///            uint32 name length, name bytes, uint8 kind, uint64 size, followed by
+///              primitives: uint8 encoding (SerializationPlan::Op::Kind),
+///              classes:    uint32 parent type id, uint32 member count, then per member:
+///                          uint32 name length, name bytes, uint32 type id, uint64 element count,
+///                          uint8 is pointer,
+///              containers: uint8 container kind, uint32 element type id, uint32 key type id,
+///                          uint8 elements are pointers.
+///            Missing type ids are written as 0xFFFFFFFF (see StreamSchema.h).
+///   Record:  uint64 record size (bytes following this field), uint32 type id,
+///            uint8 flags, uint8 padding, uint64 table index, uint32 sub-object count,
+///            uint64 sub-object table index * sub-object count, padding bytes, payload.
+///
+/// Payloads are padded so that they start at a multiple of the alignment of the record's
+/// type, measured from the start of the header. This allows records of trivially copyable
+/// types to be used in place when the data is loaded directly into memory (see MappedSnapshot).
+///
+/// The payload holds the member data of the record (parent members first) with no
+/// type or member names. Pointers are written as table indices and strings as a
+/// uint64 length followed by the characters. The table indices of nested (non-pointer)
+/// objects are stored in the sub-object list in the order they are encountered so
+/// that the payload itself is pure member data.
+///
+/// Streamed layout (see PointerTable::serializeStreaming()). Records are written while the
+/// graph is walked so neither the table size nor the schema is known up front:
+///
+///   Header:  char[4] magic "CRLS", uint32 version, uint32 byte order mark.
+///   Blocks:  uint8 block kind (binary::StreamBlock), followed by
+///              types:  uint32 type count, uint64 size, type entries as above (ids continue
+///                      from the previous types block),
+///              record: uint64 table size so far, then a record as above,
+///              end:    uint64 table size, uint64 record count.
+///
+/// The type of a record is always written before the record. Records follow the graph
+/// depth-first, so a pointer to a nested object can lead to a record for the nested object
+/// before the record of the object holding it. The reader replaces such records with the
+/// nested object once the holding object arrives.
+///
+/// Columnar layout (see SerializationFormat::Columnar). Records are grouped by type and each
+/// group is written one column at a time, a column being an operation of the type's columnar
+/// plan (see ReflectionData::columnPlan()) encoded for every record of the group in turn (and for
+/// every entry of an array of objects within each record):
+///
+///   Header:  char[4] magic "CRLC", uint32 version, uint32 byte order mark, uint64 table size,
+///            uint64 record count, uint32 type count, uint64 schema size, type entries as above,
+///            uint64 null record count, then per null record: uint32 type id, uint64 table index,
+///            followed by uint32 group count.
+///   Group:   uint64 group size (bytes following this field), uint32 type id, uint32 column
+///            count, uint64 record count, uint64 sub-object count, uint64 table index * record
+///            count, uint64 sub-object table index * sub-object count, padding bytes, then per
+///            column: uint64 column size, 8 padding bytes, column data, padding bytes.
+///
+/// Column data starts at a multiple of kColumnAlignment from the start of the header. The
+/// sub-object list holds the nested objects of every record first (record by record), then the
+/// container elements met while encoding the columns.
+///
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <assert.h>
+
+namespace carl {
+
+namespace binary {
+
+constexpr char     kMagic[4]  = { 'C', 'A', 'R', 'L' };
+constexpr uint32_t kVersion   = 3;
+constexpr uint32_t kByteOrder = 0x01020304;
+
+///
+/// Flags stored per record.
+///
+enum RecordFlags : uint8_t
+{
+    kRecordNull = 1 << 0 ///< The record represents a null pointer and has no payload.
+};
+
+///
+/// Size of the fixed portion of a record which follows the record size field.
+///
+constexpr size_t kRecordHeaderSize = sizeof(uint32_t) + 2 * sizeof(uint8_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+///
+/// Streamed binary data (see PointerTable::serializeStreaming()).
+///
+constexpr char     kStreamMagic[4] = { 'C', 'R', 'L', 'S' };
+constexpr uint32_t kStreamVersion  = 1;
+
+///
+/// Kinds of blocks in streamed binary data.
+///
+enum StreamBlock : uint8_t
+{
+    kStreamTypes = 0, ///< Types added to the schema.
+    kStreamRecord,    ///< A single record.
+    kStreamEnd        ///< End of the data.
+};
+
+///
+/// Columnar binary data (see SerializationFormat::Columnar).
+///
+constexpr char     kColumnarMagic[4] = { 'C', 'R', 'L', 'C' };
+constexpr uint32_t kColumnarVersion  = 1;
+constexpr size_t   kColumnAlignment  = 16;
+
+///
+/// Delta streams (see DeltaBaseline.h).
+///
+constexpr char     kDeltaMagic[4]  = { 'C', 'R', 'L', 'D' };
+constexpr uint32_t kDeltaVersion   = 1;
+
+///
+/// Flags stored in the header of a delta stream.
+///
+enum DeltaFlags : uint8_t
+{
+    kDeltaLayoutChanged = 1 << 0 ///< The pointer table layout differs from the baseline, every record is listed and written in full.
+};
+
+///
+/// Size of the fixed portion of a delta header.
+///
+constexpr size_t kDeltaHeaderSize = 4 + 2 * sizeof(uint32_t) + sizeof(uint8_t) + 2 * sizeof(uint64_t);
+
+} // namespace binary
+
+class BinaryWriter
+{
+public:
+    BinaryWriter() = default;
+    ~BinaryWriter() = default;
+
+    ///
+    /// Append raw bytes to the buffer.
+    ///
+    /// @param data Bytes to write.
+    /// @param size Number of bytes to write.
+    ///
+    inline void write(const void *data, size_t size)
+    {
+        const char *bytes = static_cast<const char *>(data);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+    }
+
+    ///
+    /// Append bytes to the buffer which are filled in by the caller.
+    ///
+    /// @param size Number of bytes to append.
+    /// @return Start of the appended bytes, valid until the next write.
+    ///
+    inline char *append(size_t size)
+    {
+        size_t start = m_buffer.size();
+        m_buffer.resize(start + size);
+        return m_buffer.data() + start;
+    }
+
+    ///
+    /// Append a fixed-width value to the buffer.
+    ///
+    /// @param value Value to write.
+    ///
+    template<class T>
+    inline void write(const T &value) { write(&value, sizeof(T)); }
+
+    ///
+    /// Append a string as a uint64 length followed by its characters.
+    ///
+    /// @param string String to write.
+    ///
+    inline void writeString(std::string_view string)
+    {
+        write<uint64_t>(string.length());
+        write(string.data(), string.length());
+    }
+
+    ///
+    /// Copy the contents of this buffer to an output stream.
+    ///
+    /// @param stream Stream to write to.
+    ///
+    inline void flush(std::ostream &stream) const { stream.write(m_buffer.data(), m_buffer.size()); }
+
+    inline const char *data() const { return m_buffer.data(); }
+    inline size_t size() const { return m_buffer.size(); }
+    inline void clear() { m_buffer.clear(); }
+
+private:
+
+    std::vector<char> m_buffer; ///< Staged binary data.
+};
+
+class BinaryReader
+{
+public:
+
+    ///
+    /// Construct a reader over a block of memory. The memory must outlive the reader.
+    ///
+    /// @param data Start of the binary data.
+    /// @param size Size of the binary data (in bytes).
+    ///
+    BinaryReader(const char *data = nullptr, size_t size = 0) : m_current(data), m_end(data + size) {}
+
+    ///
+    /// Copy raw bytes out of the buffer.
+    ///
+    /// @param data Destination for the bytes.
+    /// @param size Number of bytes to read.
+    ///
+    inline void read(void *data, size_t size)
+    {
+        assert(remaining() >= size);
+        memcpy(data, m_current, size);
+        m_current += size;
+    }
+
+    ///
+    /// Read a fixed-width value from the buffer.
+    ///
+    template<class T>
+    inline T read()
+    {
+        T value;
+        read(&value, sizeof(T));
+        return value;
+    }
+
+    ///
+    /// Read a string written with BinaryWriter::writeString().
+    ///
+    /// @param string String to populate.
+    ///
+    inline void readString(std::string &string)
+    {
+        uint64_t length = read<uint64_t>();
+        assert(remaining() >= length);
+        string.assign(m_current, length);
+        m_current += length;
+    }
+
+    ///
+    /// Read a string written with BinaryWriter::writeString() without copying it. The view points
+    /// into the reader's memory.
+    ///
+    /// @return View of the string's characters.
+    ///
+    inline std::string_view readStringView()
+    {
+        uint64_t length = read<uint64_t>();
+        assert(remaining() >= length);
+        std::string_view view(m_current, length);
+        m_current += length;
+        return view;
+    }
+
+    ///
+    /// Skip over bytes without reading them.
+    ///
+    /// @param size Number of bytes to skip.
+    ///
+    inline void skip(size_t size)
+    {
+        assert(remaining() >= size);
+        m_current += size;
+    }
+
+    ///
+    /// Split off the next 'size' bytes into their own reader and advance past them.
+    ///
+    /// @param size Number of bytes the new reader should cover.
+    /// @return Reader over the requested bytes.
+    ///
+    inline BinaryReader subReader(size_t size)
+    {
+        assert(remaining() >= size);
+        BinaryReader reader(m_current, size);
+        m_current += size;
+        return reader;
+    }
+
+    inline const char *position() const { return m_current; }
+    inline size_t remaining() const { return static_cast<size_t>(m_end - m_current); }
+    inline bool atEnd() const { return m_current == m_end; }
+
+private:
+
+    const char *m_current = nullptr; ///< Current read position.
+    const char *m_end = nullptr;     ///< End of the readable data.
+};
+
+///
+/// Staging area for a single record while it is being encoded.
+///
+struct BinaryRecordWriter
+{
+    BinaryWriter          payload;    ///< Member data of the record.
+    std::vector<uint64_t> subobjects; ///< Table indices of nested objects in encounter order.
+};
+
+///
+/// Readers for the two variable-length portions of a record while it is being decoded.
+///
+struct BinaryRecordReader
+{
+    BinaryReader payload;    ///< Member data of the record.
+    BinaryReader subobjects; ///< Table indices of nested objects in encounter order.
+    bool persistent = false; ///< If true, the record's memory outlives the decoded objects (std::string_view members point into it instead of copying their characters).
+    bool deferPointers = false; ///< If true, pointers are left holding their table index to be resolved later (see ReflectionData::patchBinaryPointers()).
+};
+
+} // namespace carl
@@ -0,0 +1,184 @@
+//
+//  ColumnReader.cpp
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#include "ColumnReader.h"
+#include "ReflectionData.h"
+#include "BinaryStream.h"
+
+namespace carl {
+
+void ColumnReader::open(const char *data, size_t size)
+{
+	m_schema = StreamSchema();
+	m_groups.clear();
+
+	BinaryReader reader(data, size);
+	char magic[sizeof(binary::kColumnarMagic)];
+	reader.read(magic, sizeof(magic));
+	assert(memcmp(magic, binary::kColumnarMagic, sizeof(magic)) == 0);
+	uint32_t version = reader.read<uint32_t>();
+	assert(version == binary::kColumnarVersion);
+	uint32_t byteOrder = reader.read<uint32_t>();
+	assert(byteOrder == binary::kByteOrder);
+	(void)version;
+	(void)byteOrder;
+
+	reader.skip(2 * sizeof(uint64_t));
+	uint32_t typeCount = reader.read<uint32_t>();
+	uint64_t schemaSize = reader.read<uint64_t>();
+	BinaryReader schemaReader = reader.subReader(schemaSize);
+	m_schema.read(schemaReader, typeCount);
+
+	uint64_t nullCount = reader.read<uint64_t>();
+	reader.skip(nullCount * (sizeof(uint32_t) + sizeof(uint64_t)));
+
+	uint32_t groupCount = reader.read<uint32_t>();
+	for (uint32_t ii = 0; ii < groupCount; ++ii) {
+		uint64_t groupSize = reader.read<uint64_t>();
+		BinaryReader groupReader = reader.subReader(groupSize);
+
+		uint32_t typeId = groupReader.read<uint32_t>();
+		uint32_t columnCount = groupReader.read<uint32_t>();
+		uint64_t recordCount = groupReader.read<uint64_t>();
+		uint64_t subobjectCount = groupReader.read<uint64_t>();
+		assert(typeId < m_schema.size());
+
+		// Columns are found through the registered type so it has to match the data.
+		if (m_schema.localType(typeId) == nullptr || !m_schema.isIdentical(typeId)) {
+			continue;
+		}
+
+		Group group;
+		group.type = m_schema.localType(typeId);
+		group.count = recordCount;
+		group.indices = groupReader.position();
+		groupReader.skip((recordCount + subobjectCount) * sizeof(uint64_t));
+		groupReader.skip((binary::kColumnAlignment - static_cast<size_t>(groupReader.position() - data) % binary::kColumnAlignment) % binary::kColumnAlignment);
+
+		for (uint32_t column = 0; column < columnCount; ++column) {
+			uint64_t columnSize = groupReader.read<uint64_t>();
+			groupReader.skip(sizeof(uint64_t));
+			group.columns.push_back(groupReader.position());
+			groupReader.skip(columnSize + (binary::kColumnAlignment - columnSize % binary::kColumnAlignment) % binary::kColumnAlignment);
+		}
+		m_groups.push_back(std::move(group));
+	}
+}
+
+bool ColumnReader::column(const ReflectionData *type, const std::string &member, ColumnView &column) const
+{
+	const Group *group = nullptr;
+	for (auto &candidate : m_groups) {
+		if (candidate.type == type) {
+			group = &candidate;
+			break;
+		}
+	}
+	if (group == nullptr) {
+		return false;
+	}
+
+	// Work out the offset of the member within the type, then find the column at that offset. Each entry of an
+	// array of objects crossed without an index adds its values to the column.
+	size_t offset = 0;
+	size_t count = 1;
+	size_t repeat = 1;
+	bool isPointer = false;
+	for (size_t position = 0; position < member.size();) {
+		if (isPointer) {
+			return false;
+		}
+
+		if (member[position] == '[') {
+			size_t end = member.find(']', position);
+			if (end == std::string::npos || end == position + 1) {
+				return false;
+			}
+
+			size_t element = 0;
+			for (size_t ii = position + 1; ii < end; ++ii) {
+				if (member[ii] < '0' || member[ii] > '9') {
+					return false;
+				}
+				element = element * 10 + static_cast<size_t>(member[ii] - '0');
+			}
+			if (element >= count) {
+				return false;
+			}
+
+			offset += element * type->size();
+			count = 1;
+			position = end + 1;
+			continue;
+		}
+
+		if (member[position] == '.' && position == 0) {
+			return false;
+		}
+		if (member[position] == '.') {
+			++position;
+		}
+
+		size_t end = member.find_first_of(".[", position);
+		if (end == std::string::npos) {
+			end = member.size();
+		}
+		std::string name = member.substr(position, end - position);
+		position = end;
+
+		repeat *= count;
+		count = 1;
+
+		// Members inherited from a parent type are found through the parent.
+		const ReflectedMember *found = nullptr;
+		for (const ReflectionData *owner = type; owner != nullptr && found == nullptr; owner = owner->parent()) {
+			found = owner->member(name);
+		}
+		if (found == nullptr) {
+			return false;
+		}
+
+		offset += found->offset();
+		type = found->reflectionData();
+		isPointer = found->isPointer();
+		count = isPointer ? 1 : found->size() / type->size();
+	}
+
+	// Nested objects share their offset with their first member, only leaf values are columns. The entries
+	// of an array of primitives make up a single value.
+	if (!isPointer && (type->hasDataMembers() || type->hasParent() || type->isContainer())) {
+		return false;
+	}
+	size_t size = isPointer ? sizeof(uint64_t) : count * type->size();
+
+	const SerializationPlan &plan = group->type->columnPlan();
+	for (size_t ii = 0; ii < plan.ops.size(); ++ii) {
+		const SerializationPlan::Op &op = plan.ops[ii];
+		if (op.offset != offset || op.repeat != repeat) {
+			continue;
+		}
+
+		bool matches = isPointer ? (op.kind == SerializationPlan::Op::Kind::Pointer)
+		                         : (op.kind == SerializationPlan::Op::Kind::Bytes && op.count == size);
+		if (!matches) {
+			return false;
+		}
+
+		column.data = group->columns[ii];
+		column.indices = group->indices;
+		column.count = group->count * repeat;
+		column.size = size;
+		column.repeat = repeat;
+		column.isPointer = isPointer;
+		return true;
+	}
+
+	return false;
+}
+
+} // namespace carl
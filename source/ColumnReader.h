@@ -0,0 +1,117 @@
+//
+//  ColumnReader.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Reads single columns of columnar data (see SerializationFormat::Columnar) held in memory without
+/// decoding any records. Opening the data only reads the header of each group, a column is then found
+/// by type and member path and handed out where it lies in memory.
+///
+/// Only columns of fixed-size values can be read this way: trivially copyable primitives (an array of them
+/// is one value) and pointers (as the table index of their target). The types of the data must not have
+/// changed since it was written.
+///
+
+#include "StreamSchema.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <assert.h>
+
+namespace carl {
+
+// Forward declarations.
+class ReflectionData;
+
+///
+/// The values of one member for every record of a type.
+///
+struct ColumnView
+{
+    const char *data = nullptr;    ///< First value, values follow each other without gaps.
+    const char *indices = nullptr; ///< Table index of each record (uint64 each).
+    size_t      count = 0;         ///< Number of values.
+    size_t      size = 0;          ///< Size of each value (in bytes).
+    size_t      repeat = 1;        ///< Number of consecutive values per record (member of an array of objects).
+    bool        isPointer = false; ///< If true, each value is the uint64 table index of the pointed to record.
+
+    ///
+    /// Get a single value.
+    ///
+    /// @param element Position of the value.
+    ///
+    template<class T>
+    inline T as(size_t element) const
+    {
+        assert(sizeof(T) == size && element < count);
+        T value;
+        memcpy(&value, data + element * size, sizeof(T));
+        return value;
+    }
+
+    ///
+    /// Get the table index of the record a value belongs to.
+    ///
+    /// @param element Position of the value.
+    ///
+    inline uint64_t index(size_t element) const
+    {
+        assert(element < count);
+        uint64_t value;
+        memcpy(&value, indices + (element / repeat) * sizeof(uint64_t), sizeof(uint64_t));
+        return value;
+    }
+};
+
+class ColumnReader
+{
+public:
+    ColumnReader() = default;
+    ~ColumnReader() = default;
+
+    ///
+    /// Index the groups of columnar data. Any previously opened data is forgotten.
+    ///
+    /// @param data Start of the serialized data. Must outlive the columns handed out.
+    /// @param size Size of the serialized data (in bytes).
+    ///
+    void open(const char *data, size_t size);
+
+    ///
+    /// Find the column of a member of a type.
+    ///
+    /// @param type Type of the records.
+    /// @param member Path of the member within the type, nested objects are separated by '.', e.g. "position.x".
+    ///               Arrays of objects are either crossed as a whole, giving a value per entry ("joints.angle"),
+    ///               or through a single entry selected with '[n]' when they're nested in another array.
+    /// @param column Set to the column.
+    /// @return False if there are no records of the type or the path does not name a column of fixed-size values.
+    ///
+    bool column(const ReflectionData *type, const std::string &member, ColumnView &column) const;
+
+private:
+
+    ///
+    /// A group of records of the same type.
+    ///
+    struct Group
+    {
+        const ReflectionData     *type = nullptr;    ///< Type of the records.
+        const char               *indices = nullptr; ///< Table indices of the records.
+        size_t                    count = 0;         ///< Number of records.
+        std::vector<const char *> columns;           ///< Start of the data of each column.
+    };
+
+    StreamSchema       m_schema; ///< Layout of the data.
+    std::vector<Group> m_groups; ///< Every group whose type is still registered unchanged.
+};
+
+} // namespace carl
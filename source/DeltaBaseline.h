@@ -0,0 +1,104 @@
+//
+//  DeltaBaseline.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// A retained copy of the encoded state of an object graph which later states of the same graph are
+/// compared against to write deltas (see ReflectedVariable::serializeDelta()). Only the changed members
+/// of each record are written, keyed by pointer table index and member ordinal. Member ordinals count
+/// the members of parent types first.
+///
+/// A delta is applied in place to a graph that matches the baseline, usually one that was deserialized
+/// from the same source, with ReflectedVariable::applyDelta(). Both sides populate a pointer table from
+/// their graph so the table indices agree without being transmitted.
+///
+/// Adding or removing objects changes the layout of the pointer table. The delta then contains every
+/// member of every record along with the type of each record. Applying it rewrites the target graph in
+/// place, reusing objects whose type did not change and creating the others. The same happens when a
+/// changed member holds objects that are re-created when it's decoded, such as the values of a std::map.
+/// Objects which become unreachable are not destroyed.
+///
+/// Delta stream layout (native byte order and width, see BinaryStream.h):
+///
+///   Header:  char[4] magic "CRLD", uint32 version, uint32 byte order mark, uint8 flags,
+///            uint64 table size, uint64 body size.
+///   Body:    uint32 type count, then per type: uint32 name length, name bytes.
+///            If the layout changed: uint64 record count, then per record: uint64 table index,
+///            uint32 type id, uint8 record flags.
+///            uint64 change count, then per change: uint64 table index, uint32 member ordinal,
+///            uint32 sub-object count, uint64 payload size, sub-object table indices, payload.
+///
+/// Members are encoded exactly as they are in a binary record. The characters of changed std::string_view
+/// members are kept by the allocator passed to PointerTable::applyDelta().
+///
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace carl {
+
+// Forward declarations.
+class ReflectionData;
+
+class DeltaBaseline
+{
+public:
+
+    ///
+    /// Determine if this baseline has captured a graph yet.
+    ///
+    /// @return If true, nothing has been captured and the next delta will contain the entire graph.
+    ///
+    inline bool empty() const { return m_entries.empty(); }
+
+    ///
+    /// Forget the captured state.
+    ///
+    void clear()
+    {
+        m_entries.clear();
+        m_members.clear();
+        m_payload.clear();
+        m_subobjects.clear();
+    }
+
+private:
+
+    friend class PointerTable;
+
+    ///
+    /// State of a single pointer table entry.
+    ///
+    struct Entry
+    {
+        const ReflectionData *type = nullptr;  ///< Type of the entry.
+        bool                  isRecord = false; ///< If true, the entry is serialized on its own rather than as part of another object.
+        bool                  isNull = false;   ///< If true, the entry is a null pointer.
+        size_t                firstMember = 0;  ///< Index of the entry's first member in m_members (records only).
+    };
+
+    ///
+    /// Encoded state of a single member of a record.
+    ///
+    struct Member
+    {
+        size_t payloadOffset = 0;   ///< Start of the member's payload in m_payload.
+        size_t payloadSize = 0;     ///< Size of the member's payload (in bytes).
+        size_t subobjectOffset = 0; ///< Start of the member's sub-object indices in m_subobjects.
+        size_t subobjectCount = 0;  ///< Number of sub-object indices of the member.
+    };
+
+    std::vector<Entry>    m_entries;    ///< One entry per pointer table entry.
+    std::vector<Member>   m_members;    ///< Members of every record, in table order.
+    std::vector<char>     m_payload;    ///< Payloads of every member.
+    std::vector<uint64_t> m_subobjects; ///< Sub-object indices of every member.
+};
+
+} // namespace carl
@@ -0,0 +1,126 @@
+//
+//  GraphComparer.cpp
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#include "GraphComparer.h"
+#include "ReflectionData.h"
+
+#include <assert.h>
+
+namespace carl {
+
+namespace {
+
+///
+/// Parent of the root visit.
+///
+constexpr size_t kNoParent = static_cast<size_t>(-1);
+
+} // namespace
+
+GraphComparer::GraphComparer(bool findAll) :
+	m_findAll(findAll)
+{
+}
+
+bool GraphComparer::compare(const ReflectedVariable &lhs, const ReflectedVariable &rhs)
+{
+	assert(m_visits.empty());
+	assert(lhs.reflectionData() == rhs.reflectionData());
+
+	if (lhs.instanceData() == nullptr || rhs.instanceData() == nullptr) {
+		if (lhs.instanceData() != rhs.instanceData()) {
+			addDifference("");
+		}
+		return m_differences.empty();
+	}
+
+	matchObject(lhs.reflectionData(), lhs.instanceData(), rhs.instanceData());
+	m_visits.push_back({ lhs, rhs.instanceData(), kNoParent, nullptr });
+
+	// Visits are appended while comparing, so the list can't be iterated with references.
+	for (m_currentVisit = 0; m_currentVisit < m_visits.size() && !finished(); ++m_currentVisit) {
+		const ReflectionData *reflectionData = m_visits[m_currentVisit].lhs.reflectionData();
+		const void *lhsData = m_visits[m_currentVisit].lhs.instanceData();
+		const void *rhsData = m_visits[m_currentVisit].rhs;
+
+		if (!reflectionData->equals(lhsData, rhsData, *this)) {
+			// Something differs, walk the members one by one to find out what.
+			reflectionData->diff(lhsData, rhsData, visitPath(m_currentVisit), *this);
+		}
+	}
+
+	return m_differences.empty();
+}
+
+bool GraphComparer::matchPointer(const ReflectionData *type, const void *lhs, const void *rhs, const void *slot)
+{
+	if (lhs == nullptr || rhs == nullptr) {
+		return (lhs == rhs);
+	}
+
+	AddressTable::Index lhsPair = m_lhsPairs.find(reinterpret_cast<size_t>(lhs), type);
+	AddressTable::Index rhsPair = m_rhsPairs.find(reinterpret_cast<size_t>(rhs), type);
+	if (lhsPair != AddressTable::kNotFound || rhsPair != AddressTable::kNotFound) {
+		return (lhsPair == rhsPair);
+	}
+
+	bool inserted = false;
+	m_lhsPairs.insert(reinterpret_cast<size_t>(lhs), type, m_pairCount, inserted);
+	m_rhsPairs.insert(reinterpret_cast<size_t>(rhs), type, m_pairCount, inserted);
+	++m_pairCount;
+
+	m_visits.push_back({ ReflectedVariable(type, const_cast<void *>(lhs)), rhs, m_currentVisit, slot });
+	return true;
+}
+
+bool GraphComparer::matchObject(const ReflectionData *type, const void *lhs, const void *rhs)
+{
+	bool lhsInserted = false;
+	bool rhsInserted = false;
+	AddressTable::Index lhsPair = m_lhsPairs.insert(reinterpret_cast<size_t>(lhs), type, m_pairCount, lhsInserted);
+	AddressTable::Index rhsPair = m_rhsPairs.insert(reinterpret_cast<size_t>(rhs), type, m_pairCount, rhsInserted);
+	if (lhsInserted && rhsInserted) {
+		++m_pairCount;
+		return true;
+	}
+
+	// Only one side being new means it got the next pair id, which can't match the other side.
+	if (lhsInserted || rhsInserted) {
+		++m_pairCount;
+		return false;
+	}
+
+	return (lhsPair == rhsPair);
+}
+
+std::string GraphComparer::visitPath(size_t visit) const
+{
+	// Collect the visits from the root down, then name each pointer within the object holding it.
+	std::vector<size_t> chain;
+	for (size_t current = visit; m_visits[current].parent != kNoParent; current = m_visits[current].parent) {
+		chain.push_back(current);
+	}
+
+	std::string path;
+	for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+		const Visit &parent = m_visits[m_visits[*it].parent];
+		std::string segment;
+		bool found = parent.lhs.reflectionData()->findMemberPath(parent.lhs.instanceData(), m_visits[*it].slot, segment);
+		assert(found);
+		(void)found;
+
+		if (!path.empty()) {
+			path += ".";
+		}
+		path += segment;
+	}
+
+	return path;
+}
+
+} // namespace carl
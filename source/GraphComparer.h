@@ -0,0 +1,131 @@
+//
+//  GraphComparer.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Deep structural comparison of two object graphs of the same type (see ReflectedVariable::equals()
+/// and ReflectedVariable::diff()). Both graphs are walked in lockstep. Pointers are followed through
+/// an isomorphism map which pairs each object of one graph with an object of the other, so graphs
+/// with the same contents and shape compare equal no matter where they live in memory. A pointer
+/// which would pair an object with a second partner is a difference.
+///
+/// Objects are first compared with their serialization plan (runs of plain bytes are compared as a
+/// single block). Only objects which differ are walked member by member to find the paths of the
+/// differing members. Values are compared bitwise, so NaN equals itself and -0.0 differs from 0.0.
+///
+/// Paths are written like C++ expressions relative to the root: "next.next.items[3].x". Map
+/// elements are named by their key. An object reachable through several paths is named by the path
+/// it was first reached through.
+///
+
+#include "ReflectedVariable.h"
+#include "AddressTable.h"
+
+#include <string>
+#include <vector>
+
+namespace carl {
+
+class GraphComparer
+{
+public:
+
+    ///
+    /// @param findAll If false, the comparison stops at the first difference.
+    ///
+    explicit GraphComparer(bool findAll = false);
+    ~GraphComparer() = default;
+
+    // This comparer is not copyable.
+    GraphComparer(const GraphComparer &other) = delete;
+    GraphComparer &operator=(const GraphComparer &other) = delete;
+
+    ///
+    /// Compare two graphs. A comparer can only be used once.
+    ///
+    /// @param lhs Root of the first graph.
+    /// @param rhs Root of the second graph, must be of the same type as 'lhs'.
+    /// @return If true, the graphs are equal.
+    ///
+    bool compare(const ReflectedVariable &lhs, const ReflectedVariable &rhs);
+
+    ///
+    /// Get the paths of the members which differ.
+    ///
+    /// @return Differing member paths in the order they were found.
+    ///
+    inline const std::vector<std::string> &differences() const { return m_differences; }
+
+    ///
+    /// Match a pointer of the first graph with a pointer of the second graph. Objects which haven't been
+    /// paired yet are paired and queued to be compared.
+    ///
+    /// @param type Type of the pointed to objects.
+    /// @param lhs Pointer from the first graph.
+    /// @param rhs Pointer from the second graph.
+    /// @param slot Address of the pointer in the first graph, used to name the object if it differs.
+    /// @return If true, the pointers are consistent with the objects paired so far.
+    ///
+    bool matchPointer(const ReflectionData *type, const void *lhs, const void *rhs, const void *slot);
+
+    ///
+    /// Pair two nested objects which are compared as part of the objects holding them.
+    ///
+    /// @param type Type of the nested objects.
+    /// @param lhs Nested object of the first graph.
+    /// @param rhs Nested object of the second graph.
+    /// @return If true, the objects are consistent with the objects paired so far.
+    ///
+    bool matchObject(const ReflectionData *type, const void *lhs, const void *rhs);
+
+    ///
+    /// Record a difference.
+    ///
+    /// @param path Path of the differing member.
+    ///
+    inline void addDifference(const std::string &path) { m_differences.push_back(path); }
+
+    ///
+    /// Determine if the comparison can stop.
+    ///
+    /// @return If true, a difference has been found and only the first one was asked for.
+    ///
+    inline bool finished() const { return (!m_findAll && !m_differences.empty()); }
+
+private:
+
+    ///
+    /// A pair of objects reached through a pointer, waiting to be compared.
+    ///
+    struct Visit
+    {
+        ReflectedVariable lhs;              ///< Object of the first graph.
+        const void       *rhs = nullptr;    ///< Object of the second graph.
+        size_t            parent = 0;       ///< Visit which holds the pointer leading to this one.
+        const void       *slot = nullptr;   ///< Address of that pointer in the first graph.
+    };
+
+    ///
+    /// Build the path of the object compared by a visit.
+    ///
+    /// @param visit Index of the visit.
+    /// @return Path from the root to the object, empty for the root.
+    ///
+    std::string visitPath(size_t visit) const;
+
+    bool                     m_findAll = false;  ///< If true, every difference is reported.
+    AddressTable             m_lhsPairs;         ///< Pair id per object of the first graph.
+    AddressTable             m_rhsPairs;         ///< Pair id per object of the second graph.
+    size_t                   m_pairCount = 0;    ///< Number of objects paired so far.
+    std::vector<Visit>       m_visits;           ///< Objects to compare, in the order they were reached.
+    size_t                   m_currentVisit = 0; ///< Visit currently being compared.
+    std::vector<std::string> m_differences;      ///< Paths of the differing members.
+};
+
+} // namespace carl
@@ -0,0 +1,142 @@
+//
+//  Hasher.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Streaming 64-bit hash used for structural hashing of object graphs (see ReflectedVariable::hash()).
+/// Data is consumed 8 bytes at a time; large blocks are spread across four independent lanes so that
+/// the multiplies of consecutive words can overlap. The result depends on how the data is split
+/// between calls to update(), which is fine as the same graph always produces the same calls.
+///
+/// This is not a cryptographic hash.
+///
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace carl {
+
+class Hasher
+{
+public:
+
+    ///
+    /// @param seed Seed to start from.
+    ///
+    explicit Hasher(uint64_t seed = 0) :
+        m_state(seed + kPrime5)
+    {
+        m_lanes[0] = seed + kPrime1 + kPrime2;
+        m_lanes[1] = seed + kPrime2;
+        m_lanes[2] = seed;
+        m_lanes[3] = seed - kPrime1;
+    }
+
+    ///
+    /// Add a block of memory to the hash.
+    ///
+    /// @param data Start of the block.
+    /// @param size Size of the block (in bytes).
+    ///
+    inline void update(const void *data, size_t size)
+    {
+        const char *bytes = static_cast<const char *>(data);
+        m_length += size;
+
+        for (; size >= 32; bytes += 32, size -= 32) {
+            m_lanes[0] = round(m_lanes[0], load(bytes));
+            m_lanes[1] = round(m_lanes[1], load(bytes + 8));
+            m_lanes[2] = round(m_lanes[2], load(bytes + 16));
+            m_lanes[3] = round(m_lanes[3], load(bytes + 24));
+        }
+
+        for (; size >= 8; bytes += 8, size -= 8) {
+            mix(load(bytes));
+        }
+
+        if (size > 0) {
+            uint64_t word = 0;
+            memcpy(&word, bytes, size);
+            mix(word ^ (static_cast<uint64_t>(size) << 56));
+        }
+    }
+
+    ///
+    /// Add a trivially copyable value to the hash.
+    ///
+    /// @param value Value to add.
+    ///
+    template<class T>
+    inline void add(const T &value) { update(&value, sizeof(T)); }
+
+    ///
+    /// Get the hash of everything added so far.
+    ///
+    /// @return 64-bit hash.
+    ///
+    inline uint64_t digest() const
+    {
+        uint64_t hash = m_state ^ m_length;
+        hash = merge(hash, m_lanes[0]);
+        hash = merge(hash, m_lanes[1]);
+        hash = merge(hash, m_lanes[2]);
+        hash = merge(hash, m_lanes[3]);
+
+        // Final avalanche.
+        hash ^= hash >> 33;
+        hash *= kPrime2;
+        hash ^= hash >> 29;
+        hash *= kPrime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+private:
+
+    static constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+    static constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+    static constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+    static constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+    static inline uint64_t load(const char *bytes)
+    {
+        uint64_t word;
+        memcpy(&word, bytes, sizeof(word));
+        return word;
+    }
+
+    static inline uint64_t rotateLeft(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+    static inline uint64_t round(uint64_t lane, uint64_t word)
+    {
+        lane += word * kPrime2;
+        lane = rotateLeft(lane, 31);
+        return lane * kPrime1;
+    }
+
+    static inline uint64_t merge(uint64_t hash, uint64_t lane)
+    {
+        hash ^= round(0, lane);
+        return hash * kPrime1 + kPrime4;
+    }
+
+    inline void mix(uint64_t word)
+    {
+        m_state ^= round(0, word);
+        m_state = rotateLeft(m_state, 27) * kPrime1 + kPrime4;
+    }
+
+    uint64_t m_state = 0;    ///< State for data consumed a word at a time.
+    uint64_t m_lanes[4];     ///< States for data consumed 32 bytes at a time.
+    uint64_t m_length = 0;   ///< Total number of bytes added.
+};
+
+} // namespace carl
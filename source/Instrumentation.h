@@ -0,0 +1,133 @@
+//
+//  Instrumentation.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Optional per-type statistics for serialization and deserialization. Instrumentation is
+/// compiled in by defining CARL_INSTRUMENTATION=1 (the CARL_INSTRUMENTATION CMake option) and
+/// costs nothing otherwise: the counters don't exist and the CARL_INSTRUMENT_* macros expand to
+/// nothing. Statistics are collected per pointer table record and attributed to the record's type;
+/// nested objects and parent members count towards the record that contains them.
+///
+/// Collected statistics are queried with ReflectionDataManager::statistics().
+///
+
+#include <cstdint>
+#include <string>
+
+#ifndef CARL_INSTRUMENTATION
+#define CARL_INSTRUMENTATION 0
+#endif
+
+#if CARL_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace carl {
+
+///
+/// Statistics collected for a single type.
+///
+struct TypeStatistics
+{
+    std::string name;                       ///< Name of the type.
+    uint64_t    objectsWritten = 0;         ///< Number of records of this type serialized.
+    uint64_t    objectsRead = 0;            ///< Number of records of this type deserialized.
+    uint64_t    bytesWritten = 0;           ///< Bytes written for records of this type (excluding record headers in the binary format).
+    uint64_t    bytesRead = 0;              ///< Bytes read for records of this type (excluding record headers in the binary format).
+    uint64_t    serializeNanoseconds = 0;   ///< Cumulative time spent serializing records of this type.
+    uint64_t    deserializeNanoseconds = 0; ///< Cumulative time spent deserializing records of this type.
+};
+
+#if CARL_INSTRUMENTATION
+
+///
+/// Thread safe counters backing TypeStatistics, one set per reflected type.
+///
+class TypeCounters
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    inline void recordWrite(uint64_t bytes, Clock::time_point start)
+    {
+        m_objectsWritten.fetch_add(1, std::memory_order_relaxed);
+        m_bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+        m_serializeNanoseconds.fetch_add(elapsed(start), std::memory_order_relaxed);
+    }
+
+    inline void recordRead(uint64_t bytes, Clock::time_point start)
+    {
+        m_objectsRead.fetch_add(1, std::memory_order_relaxed);
+        m_bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+        m_deserializeNanoseconds.fetch_add(elapsed(start), std::memory_order_relaxed);
+    }
+
+    ///
+    /// Copy the current counter values.
+    ///
+    /// @param statistics Statistics to populate (the name is left untouched).
+    ///
+    inline void read(TypeStatistics &statistics) const
+    {
+        statistics.objectsWritten = m_objectsWritten.load(std::memory_order_relaxed);
+        statistics.objectsRead = m_objectsRead.load(std::memory_order_relaxed);
+        statistics.bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+        statistics.bytesRead = m_bytesRead.load(std::memory_order_relaxed);
+        statistics.serializeNanoseconds = m_serializeNanoseconds.load(std::memory_order_relaxed);
+        statistics.deserializeNanoseconds = m_deserializeNanoseconds.load(std::memory_order_relaxed);
+    }
+
+    inline void reset()
+    {
+        m_objectsWritten = 0;
+        m_objectsRead = 0;
+        m_bytesWritten = 0;
+        m_bytesRead = 0;
+        m_serializeNanoseconds = 0;
+        m_deserializeNanoseconds = 0;
+    }
+
+private:
+
+    static inline uint64_t elapsed(Clock::time_point start)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    std::atomic<uint64_t> m_objectsWritten { 0 };
+    std::atomic<uint64_t> m_objectsRead { 0 };
+    std::atomic<uint64_t> m_bytesWritten { 0 };
+    std::atomic<uint64_t> m_bytesRead { 0 };
+    std::atomic<uint64_t> m_serializeNanoseconds { 0 };
+    std::atomic<uint64_t> m_deserializeNanoseconds { 0 };
+};
+
+///
+/// Start timing a record.
+///
+#define CARL_INSTRUMENT_START(timer) const carl::TypeCounters::Clock::time_point timer = carl::TypeCounters::Clock::now()
+
+///
+/// Record that a record of 'reflectionData' was written (or read) using 'bytes' bytes since 'timer' was started.
+///
+#define CARL_INSTRUMENT_WRITE(reflectionData, timer, bytes) (reflectionData)->counters().recordWrite((bytes), (timer))
+#define CARL_INSTRUMENT_READ(reflectionData, timer, bytes) (reflectionData)->counters().recordRead((bytes), (timer))
+
+#else
+
+#define CARL_INSTRUMENT_START(timer)
+#define CARL_INSTRUMENT_WRITE(reflectionData, timer, bytes)
+#define CARL_INSTRUMENT_READ(reflectionData, timer, bytes)
+
+#endif // CARL_INSTRUMENTATION
+
+} // namespace carl
@@ -0,0 +1,134 @@
+//
+//  MappedSnapshot.cpp
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#include "MappedSnapshot.h"
+
+#include <assert.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace carl {
+
+namespace {
+
+///
+/// Map an entire file privately (copy-on-write) into memory.
+///
+/// @param path Path of the file to map.
+/// @param size Set to the size of the file.
+/// @return Start of the mapping, nullptr on failure.
+///
+char *mapFile(const std::string &path, size_t &size)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return nullptr;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr) {
+		return nullptr;
+	}
+
+	void *data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(mapping);
+	if (data == nullptr) {
+		return nullptr;
+	}
+
+	size = static_cast<size_t>(fileSize.QuadPart);
+	return static_cast<char *>(data);
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return nullptr;
+	}
+
+	struct stat fileInfo;
+	if (fstat(file, &fileInfo) != 0 || fileInfo.st_size == 0) {
+		close(file);
+		return nullptr;
+	}
+
+	void *data = mmap(nullptr, static_cast<size_t>(fileInfo.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED) {
+		return nullptr;
+	}
+
+	size = static_cast<size_t>(fileInfo.st_size);
+	return static_cast<char *>(data);
+#endif
+}
+
+void unmapFile(char *data, size_t size)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap(data, size);
+#endif
+}
+
+} // namespace
+
+MappedSnapshot::~MappedSnapshot()
+{
+	unload();
+}
+
+bool MappedSnapshot::load(const std::string &path, const InPlaceOptions &options)
+{
+	unload();
+
+	m_data = mapFile(path, m_size);
+	if (m_data == nullptr) {
+		m_size = 0;
+		return false;
+	}
+
+	m_table.deserializeInPlace(m_data, m_size, options);
+	return true;
+}
+
+void MappedSnapshot::unload()
+{
+	if (m_data == nullptr) {
+		return;
+	}
+
+	// Objects have to go before the mapping as they may refer to it.
+	m_table.clear();
+	unmapFile(m_data, m_size);
+	m_data = nullptr;
+	m_size = 0;
+}
+
+const ReflectedVariable &MappedSnapshot::root()
+{
+	assert(isLoaded());
+	return m_table.pointer(0);
+}
+
+} // namespace carl
@@ -0,0 +1,98 @@
+//
+//  MappedSnapshot.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Loads a reflected variable that was serialized to a file in the binary format by
+/// memory mapping the file and decoding it in place. Records of block copyable types are
+/// used directly from the mapping (which is private and copy-on-write, so they can be
+/// modified) and std::string_view members point into it. Everything loaded is owned by
+/// the snapshot and released when it is unloaded.
+///
+
+#include "PointerTable.h"
+
+#include <string>
+
+namespace carl {
+
+class MappedSnapshot
+{
+public:
+    MappedSnapshot() = default;
+    ~MappedSnapshot();
+
+    // A snapshot owns its mapping and objects and is not copyable.
+    MappedSnapshot(const MappedSnapshot &other) = delete;
+    MappedSnapshot &operator=(const MappedSnapshot &other) = delete;
+
+    ///
+    /// Map a file written with ReflectedVariable::serialize(stream, SerializationFormat::Binary) and load it.
+    /// Any previously loaded snapshot is unloaded first.
+    ///
+    /// @param path Path to the file to load.
+    /// @param options Options controlling how records are loaded.
+    /// @return False if the file could not be opened or mapped.
+    ///
+    bool load(const std::string &path, const InPlaceOptions &options = InPlaceOptions());
+
+    ///
+    /// Destroy all loaded objects and unmap the file.
+    ///
+    void unload();
+
+    ///
+    /// Is a snapshot currently loaded?
+    ///
+    /// @return If true, a snapshot is loaded.
+    ///
+    inline bool isLoaded() const { return m_data != nullptr; }
+
+    ///
+    /// Get the root variable of the snapshot (the variable that was originally serialized).
+    ///
+    /// @return The root variable.
+    ///
+    const ReflectedVariable &root();
+
+    ///
+    /// Get the root variable of the snapshot as a specific type.
+    ///
+    template<typename T>
+    T *root() { return static_cast<T *>(const_cast<void *>(root().instanceData())); }
+
+    ///
+    /// Get access to the table holding every loaded object.
+    ///
+    /// @return The table of loaded objects.
+    ///
+    inline PointerTable &table() { return m_table; }
+
+    ///
+    /// Get the mapped file. Records referenced in place and std::string_view members point into it.
+    ///
+    /// @return Start of the mapping, nullptr if no snapshot is loaded.
+    ///
+    inline const char *data() const { return m_data; }
+
+    ///
+    /// Get the size of the mapped file.
+    ///
+    /// @return Size of the mapping (in bytes).
+    ///
+    inline size_t size() const { return m_size; }
+
+private:
+
+    PointerTable m_table;             ///< Table of loaded objects.
+    char        *m_data = nullptr;    ///< Start of the mapped file.
+    size_t       m_size = 0;          ///< Size of the mapped file (in bytes).
+};
+
+} // namespace carl
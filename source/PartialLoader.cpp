@@ -0,0 +1,422 @@
+//
+//  PartialLoader.cpp
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#include "PartialLoader.h"
+#include "ReflectionContainers.h"
+
+#include <assert.h>
+#include <cstring>
+
+namespace carl {
+
+PartialLoader::~PartialLoader()
+{
+	close();
+}
+
+void PartialLoader::open(const char *data, size_t size, Allocator *allocator)
+{
+	close();
+
+	BinaryReader reader(data, size);
+	char magic[sizeof(binary::kMagic)];
+	reader.read(magic, sizeof(magic));
+
+	m_table.prepareAllocator(allocator, 0);
+	if (memcmp(magic, binary::kStreamMagic, sizeof(magic)) == 0) {
+		openStreamed(reader);
+	} else {
+		// The regular header is read as a whole, magic included.
+		reader = BinaryReader(data, size);
+		openRegular(reader);
+	}
+
+	m_resolved.assign(m_table.size(), false);
+}
+
+void PartialLoader::openRegular(BinaryReader &reader)
+{
+	m_table.readBinaryHeader(reader, m_header);
+	BinaryReader schemaReader = reader.subReader(m_header.schemaSize);
+	m_header.schema.read(schemaReader, m_header.typeCount);
+
+	m_owners.assign(m_table.size(), kNoRecord);
+	m_records.reserve(m_header.recordCount);
+	for (uint64_t ii = 0; ii < m_header.recordCount; ++ii) {
+		uint64_t recordSize = reader.read<uint64_t>();
+		assert(recordSize >= binary::kRecordHeaderSize);
+		addRecord(reader.subReader(recordSize));
+	}
+}
+
+void PartialLoader::openStreamed(BinaryReader &reader)
+{
+	uint32_t version = reader.read<uint32_t>();
+	assert(version == binary::kStreamVersion);
+	uint32_t byteOrder = reader.read<uint32_t>();
+	assert(byteOrder == binary::kByteOrder);
+	(void)version;
+	(void)byteOrder;
+
+	for (bool finished = false; !finished;) {
+		switch (reader.read<uint8_t>()) {
+			case binary::kStreamTypes:
+			{
+				uint32_t typeCount = reader.read<uint32_t>();
+				uint64_t typesSize = reader.read<uint64_t>();
+				BinaryReader typesReader = reader.subReader(typesSize);
+				m_header.schema.read(typesReader, typeCount);
+				m_header.typeCount += typeCount;
+				break;
+			}
+
+			case binary::kStreamRecord:
+			{
+				// Tables only grow, so records written later never hold smaller indices.
+				uint64_t tableSize = reader.read<uint64_t>();
+				uint64_t recordSize = reader.read<uint64_t>();
+				assert(recordSize >= binary::kRecordHeaderSize);
+				if (tableSize > m_table.size()) {
+					m_table.m_dataTable.resize(tableSize);
+					m_owners.resize(tableSize, kNoRecord);
+				}
+
+				addRecord(reader.subReader(recordSize));
+				++m_header.recordCount;
+				break;
+			}
+
+			case binary::kStreamEnd:
+			{
+				uint64_t tableSize = reader.read<uint64_t>();
+				uint64_t recordCount = reader.read<uint64_t>();
+				assert(tableSize >= m_table.size() && recordCount == m_header.recordCount);
+				(void)recordCount;
+				m_table.m_dataTable.resize(tableSize);
+				m_owners.resize(tableSize, kNoRecord);
+				finished = true;
+				break;
+			}
+
+			default:
+				assert(false && "Unknown block in streamed binary data");
+				return;
+		}
+	}
+}
+
+void PartialLoader::addRecord(BinaryReader reader)
+{
+	Record record;
+	record.data = reader.position();
+	record.size = reader.remaining();
+
+	size_t position = m_records.size();
+	m_records.push_back(record);
+
+	// Only the header and the indices of the nested objects are read, the payload is skipped.
+	reader.skip(sizeof(uint32_t));
+	uint8_t flags = reader.read<uint8_t>();
+	reader.skip(sizeof(uint8_t));
+	uint64_t index = reader.read<uint64_t>();
+	uint32_t subobjectCount = reader.read<uint32_t>();
+	assert(index < m_owners.size());
+
+	// A nested object may have been written as a record of its own first (streamed data), the record of the
+	// object holding it comes later and takes over its index (as it does when all records are decoded).
+	m_owners[index] = position;
+	if (flags & binary::kRecordNull) {
+		return;
+	}
+
+	for (uint32_t ii = 0; ii < subobjectCount; ++ii) {
+		uint64_t subobject = reader.read<uint64_t>();
+		assert(subobject < m_owners.size());
+		m_owners[subobject] = position;
+	}
+}
+
+void PartialLoader::close()
+{
+	m_table.clear();
+	m_header = PointerTable::BinaryHeader();
+	m_records.clear();
+	m_owners.clear();
+	m_resolved.clear();
+	m_pointers.clear();
+	m_waiting.clear();
+	m_decodedCount = 0;
+}
+
+ReflectedVariable PartialLoader::load(PointerTable::TableIndex index)
+{
+	assert(index < m_table.size());
+	decode(index);
+
+	const ReflectedVariable &variable = m_table.pointer(index);
+	if (!m_resolved[index]) {
+		m_resolved[index] = true;
+		if (variable.instanceData() != nullptr) {
+			resolve(variable.reflectionData(), const_cast<void *>(variable.instanceData()));
+		}
+	}
+
+	return variable;
+}
+
+bool PartialLoader::load(const std::string &path, ReflectedVariable &variable)
+{
+	if (m_records.empty()) {
+		return false;
+	}
+
+	decode(0);
+	const ReflectedVariable &root = m_table.pointer(0);
+	if (root.instanceData() == nullptr) {
+		return false;
+	}
+
+	Cursor cursor;
+	cursor.type = root.reflectionData();
+	cursor.address = static_cast<char *>(const_cast<void *>(root.instanceData()));
+
+	for (size_t position = 0; position < path.size();) {
+		if (path[position] == '[') {
+			size_t end = path.find(']', position);
+			if (end == std::string::npos || end == position + 1) {
+				return false;
+			}
+
+			size_t element = 0;
+			for (size_t ii = position + 1; ii < end; ++ii) {
+				if (path[ii] < '0' || path[ii] > '9') {
+					return false;
+				}
+				element = element * 10 + static_cast<size_t>(path[ii] - '0');
+			}
+			position = end + 1;
+
+			// Entries of C arrays are selected in place, anything else has to be a container.
+			if (cursor.count > 1) {
+				if (element >= cursor.count) {
+					return false;
+				}
+				cursor.address += element * cursor.type->size();
+				cursor.count = 1;
+				continue;
+			}
+
+			if (cursor.isPointer && !followPointer(cursor)) {
+				return false;
+			}
+
+			if (!cursor.type->isContainer()) {
+				return false;
+			}
+
+			const ContainerInfo &info = *cursor.type->container();
+			if (element >= info.size(cursor.address)) {
+				return false;
+			}
+
+			char *found = nullptr;
+			if (info.isContiguous()) {
+				found = static_cast<char *>(info.data(cursor.address)) + element * info.elementSize;
+			} else {
+				size_t current = 0;
+				info.forEachElement(cursor.address, [&](const void *, void *value) {
+					if (current++ == element) {
+						found = static_cast<char *>(value);
+					}
+				});
+			}
+
+			cursor.type = info.element;
+			cursor.address = found;
+			cursor.count = 1;
+			cursor.isPointer = info.elementIsPointer;
+			continue;
+		}
+
+		if (path[position] == '.') {
+			if (position == 0) {
+				return false;
+			}
+			++position;
+		}
+
+		size_t end = path.find_first_of(".[", position);
+		if (end == std::string::npos) {
+			end = path.size();
+		}
+		if (end == position) {
+			return false;
+		}
+		std::string name = path.substr(position, end - position);
+		position = end;
+
+		if (cursor.count > 1) {
+			return false;
+		}
+
+		if (cursor.isPointer && !followPointer(cursor)) {
+			return false;
+		}
+
+		// Members inherited from a parent type are found through the parent.
+		const ReflectedMember *member = nullptr;
+		for (const ReflectionData *type = cursor.type; type != nullptr && member == nullptr; type = type->parent()) {
+			member = type->member(name);
+		}
+		if (member == nullptr) {
+			return false;
+		}
+
+		cursor.type = member->reflectionData();
+		cursor.address += member->offset();
+		cursor.isPointer = member->isPointer();
+		cursor.count = cursor.isPointer ? 1 : member->size() / cursor.type->size();
+	}
+
+	if (cursor.isPointer && !followPointer(cursor)) {
+		return false;
+	}
+
+	for (size_t ii = 0; ii < cursor.count; ++ii) {
+		resolve(cursor.type, cursor.address + ii * cursor.type->size());
+	}
+
+	variable = ReflectedVariable(cursor.type, cursor.address);
+	return true;
+}
+
+void PartialLoader::decode(PointerTable::TableIndex index)
+{
+	size_t position = m_owners[index];
+	if (position == kNoRecord || m_records[position].decoded) {
+		return;
+	}
+
+	Record &record = m_records[position];
+	record.decoded = true;
+	++m_decodedCount;
+
+	BinaryReader recordReader(record.data, record.size);
+	m_table.deserializeBinaryRecord(recordReader, m_header, true, false);
+
+	// Pointers of the new objects are patched right away if their target is decoded and wait for it otherwise.
+	for (auto &pointer : m_table.m_pointersToPatch) {
+		void **slot = static_cast<void **>(const_cast<void *>(pointer.variable.instanceData()));
+		bool inserted = false;
+		m_pointers.insert(reinterpret_cast<size_t>(slot), pointer.variable.reflectionData(), pointer.index, inserted);
+
+		size_t target = m_owners[pointer.index];
+		if (target != kNoRecord && m_records[target].decoded) {
+			*slot = const_cast<void *>(m_table.pointer(pointer.index).instanceData());
+		} else {
+			*slot = nullptr;
+			if (target != kNoRecord) {
+				m_waiting[target].push_back({ slot, pointer.index });
+			}
+		}
+	}
+	m_table.m_pointersToPatch.clear();
+
+	auto waiting = m_waiting.find(position);
+	if (waiting != m_waiting.end()) {
+		for (auto &pointer : waiting->second) {
+			*pointer.first = const_cast<void *>(m_table.pointer(pointer.second).instanceData());
+		}
+		m_waiting.erase(waiting);
+	}
+}
+
+void PartialLoader::resolve(const ReflectionData *type, void *address)
+{
+	std::vector<std::pair<void **, const ReflectionData *>> slots;
+	std::vector<std::pair<const ReflectionData *, void *>> pending = { { type, address } };
+
+	while (!pending.empty()) {
+		auto object = pending.back();
+		pending.pop_back();
+
+		slots.clear();
+		gatherPointers(object.first, object.second, false, slots);
+		for (auto &slot : slots) {
+			AddressTable::Index index = pointerIndex(slot.first, slot.second);
+			if (index == AddressTable::kNotFound || m_resolved[index]) {
+				continue;
+			}
+
+			m_resolved[index] = true;
+			decode(index);
+
+			const ReflectedVariable &target = m_table.pointer(index);
+			if (target.instanceData() != nullptr) {
+				pending.push_back({ target.reflectionData(), const_cast<void *>(target.instanceData()) });
+			}
+		}
+	}
+}
+
+void PartialLoader::gatherPointers(const ReflectionData *type, void *address, bool isPointer, std::vector<std::pair<void **, const ReflectionData *>> &slots) const
+{
+	if (isPointer) {
+		slots.push_back({ static_cast<void **>(address), type });
+		return;
+	}
+
+	if (type->isContainer()) {
+		const ContainerInfo &info = *type->container();
+		info.forEachElement(address, [&](const void *, void *element) {
+			gatherPointers(info.element, element, info.elementIsPointer, slots);
+		});
+		return;
+	}
+
+	// Members inherited from a parent type are part of this object as well.
+	if (type->hasParent()) {
+		gatherPointers(type->parent(), address, false, slots);
+	}
+
+	for (auto &member : type->members()) {
+		const ReflectionData *memberData = member->reflectionData();
+		char *memberAddress = static_cast<char *>(address) + member->offset();
+		if (member->isPointer()) {
+			gatherPointers(memberData, memberAddress, true, slots);
+			continue;
+		}
+
+		for (size_t ii = 0; ii < member->size(); ii += memberData->size()) {
+			gatherPointers(memberData, memberAddress + ii, false, slots);
+		}
+	}
+}
+
+bool PartialLoader::followPointer(Cursor &cursor)
+{
+	void **slot = reinterpret_cast<void **>(cursor.address);
+	AddressTable::Index index = pointerIndex(slot, cursor.type);
+	if (index == AddressTable::kNotFound) {
+		return false;
+	}
+
+	decode(index);
+	const ReflectedVariable &target = m_table.pointer(index);
+	if (target.instanceData() == nullptr) {
+		return false;
+	}
+
+	cursor.type = target.reflectionData();
+	cursor.address = static_cast<char *>(const_cast<void *>(target.instanceData()));
+	cursor.count = 1;
+	cursor.isPointer = false;
+	return true;
+}
+
+} // namespace carl
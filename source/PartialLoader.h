@@ -0,0 +1,193 @@
+//
+//  PartialLoader.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Loads selected parts of binary data held in memory instead of the whole graph. Opening the data
+/// only reads the header of each record (payloads are skipped by their length), then each load decodes
+/// the records holding the requested object and everything reachable from it through pointers. Other
+/// records are left undecoded until a later load needs them.
+///
+/// Objects of decoded records may hold pointers into records which haven't been decoded (e.g. a back
+/// pointer from a player to the world holding it when only the player was requested). Those pointers are
+/// null until a load decodes their target, at which point they're patched to it. Pointers reachable from
+/// a loaded object are always resolved.
+///
+/// Both the regular and the streamed layout (see BinaryStream.h) can be loaded, as can data whose types
+/// have since changed (see StreamSchema.h). Everything loaded is owned by the loader and released when it
+/// is closed.
+///
+
+#include "PointerTable.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace carl {
+
+class PartialLoader
+{
+public:
+    PartialLoader() = default;
+    ~PartialLoader();
+
+    // A loader owns its objects and is not copyable.
+    PartialLoader(const PartialLoader &other) = delete;
+    PartialLoader &operator=(const PartialLoader &other) = delete;
+
+    ///
+    /// Index the records of binary data written with ReflectedVariable::serialize(stream, SerializationFormat::Binary)
+    /// or ReflectedVariable::serializeStreaming(). Nothing is decoded yet. Any previously opened data is closed first.
+    ///
+    /// @param data Start of the serialized data. Must outlive the loaded objects (std::string_view members point into it).
+    /// @param size Size of the serialized data (in bytes).
+    /// @param allocator Allocator to create the loaded objects with, nullptr to allocate each object on the heap.
+    ///
+    void open(const char *data, size_t size, Allocator *allocator = nullptr);
+
+    ///
+    /// Destroy every loaded object and forget the data.
+    ///
+    void close();
+
+    ///
+    /// Load an object by its table index along with everything reachable from it. The root of the graph
+    /// (the variable that was originally serialized) is at index 0.
+    ///
+    /// @param index Table index of the object.
+    /// @return The loaded object, its instance data is nullptr for null pointer records and records whose type
+    ///         is no longer registered.
+    ///
+    ReflectedVariable load(PointerTable::TableIndex index);
+
+    ///
+    /// Load the value at a member path from the root along with everything reachable from it. Members are
+    /// separated by '.' and elements of C arrays and containers are selected by position with '[n]' (map
+    /// elements in key order), e.g. "players[3].inventory". Pointers along the path are followed.
+    ///
+    /// @param path Path of the value from the root.
+    /// @param variable Set to the value. A pointer at the end of the path is followed to its target.
+    /// @return False if the path does not name a value in the data.
+    ///
+    bool load(const std::string &path, ReflectedVariable &variable);
+
+    ///
+    /// Get the number of records in the data.
+    ///
+    inline size_t recordCount() const { return m_records.size(); }
+
+    ///
+    /// Get the number of records decoded so far.
+    ///
+    inline size_t decodedRecordCount() const { return m_decodedCount; }
+
+    ///
+    /// Get access to the table holding every loaded object.
+    ///
+    /// @return The table of loaded objects.
+    ///
+    inline PointerTable &table() { return m_table; }
+
+private:
+
+    ///
+    /// Marks table indices which are not held by any record.
+    ///
+    static constexpr size_t kNoRecord = static_cast<size_t>(-1);
+
+    ///
+    /// A record of the data.
+    ///
+    struct Record
+    {
+        const char *data = nullptr;  ///< Start of the record (after its size).
+        size_t      size = 0;        ///< Size of the record (in bytes).
+        bool        decoded = false; ///< If true, the objects of this record have been created.
+    };
+
+    ///
+    /// Position within a value while following a member path.
+    ///
+    struct Cursor
+    {
+        const ReflectionData *type = nullptr;   ///< Type of the value (the pointed to type for pointers).
+        char                 *address = nullptr; ///< Address of the value (the pointer itself for pointers).
+        size_t                count = 1;         ///< Number of elements at 'address' (C arrays).
+        bool                  isPointer = false; ///< If true, 'address' holds a pointer.
+    };
+
+    ///
+    /// Index the records of data in each layout.
+    ///
+    void openRegular(BinaryReader &reader);
+    void openStreamed(BinaryReader &reader);
+
+    ///
+    /// Read the header of a record and note which table indices it holds.
+    ///
+    /// @param reader Reader covering exactly the record.
+    ///
+    void addRecord(BinaryReader reader);
+
+    ///
+    /// Decode the record holding a table index if it hasn't been decoded yet.
+    ///
+    /// @param index Table index to decode.
+    ///
+    void decode(PointerTable::TableIndex index);
+
+    ///
+    /// Decode every record reachable through the pointers of an object.
+    ///
+    /// @param type Type of the object.
+    /// @param address Address of the object.
+    ///
+    void resolve(const ReflectionData *type, void *address);
+
+    ///
+    /// Gather the pointers held by a value, including those of its nested objects and containers.
+    ///
+    /// @param type Type of the value (the pointed to type for pointers).
+    /// @param address Address of the value.
+    /// @param isPointer If true, the value is a pointer.
+    /// @param slots Pointers found, with their pointed to type.
+    ///
+    void gatherPointers(const ReflectionData *type, void *address, bool isPointer, std::vector<std::pair<void **, const ReflectionData *>> &slots) const;
+
+    ///
+    /// Move a path cursor to the target of the pointer it's on, decoding the target if needed.
+    ///
+    /// @return False if the pointer is null.
+    ///
+    bool followPointer(Cursor &cursor);
+
+    ///
+    /// Find the table index written for a pointer of a decoded record.
+    ///
+    /// @return The table index, AddressTable::kNotFound if the pointer was not read from the data.
+    ///
+    inline AddressTable::Index pointerIndex(void **slot, const ReflectionData *type) const
+    {
+        return m_pointers.find(reinterpret_cast<size_t>(slot), type);
+    }
+
+    using WaitingPointers = std::vector<std::pair<void **, PointerTable::TableIndex>>;
+
+    PointerTable                              m_table;            ///< Table of loaded objects.
+    PointerTable::BinaryHeader                m_header;           ///< Header and schema of the data.
+    std::vector<Record>                       m_records;          ///< Every record of the data, in the order they were written.
+    std::vector<size_t>                       m_owners;           ///< Position in m_records of the record holding each table index.
+    std::vector<bool>                         m_resolved;         ///< Table indices whose reachable records have been decoded.
+    AddressTable                              m_pointers;         ///< Table index written for each pointer of the decoded records.
+    std::unordered_map<size_t, WaitingPointers> m_waiting;        ///< Null pointers (and their target) per undecoded record they point into.
+    size_t                                    m_decodedCount = 0; ///< Number of decoded records.
+};
+
+} // namespace carl
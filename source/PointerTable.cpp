@@ -8,113 +8,287 @@
 
 #include "PointerTable.h"
 #include "ReflectionDataManager.h"
+#include "ReflectionContainers.h"
 #include "ReflectionUtilities.h"
 
+#include "BinaryStream.h"
+#include "TextStream.h"
+#include "DeltaBaseline.h"
+#include "Hasher.h"
+#include "Allocator.h"
+#include "ThreadPool.h"
+
 #include <assert.h>
+#include <algorithm>
 #include <istream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace carl {
 
+#if CARL_INSTRUMENTATION
+namespace {
+
+///
+/// Number of bytes between two stream positions, 0 if the stream could not report its position.
+///
+uint64_t streamDistance(std::streampos start, std::streampos end)
+{
+	if (start == std::streampos(-1) || end == std::streampos(-1)) {
+		return 0;
+	}
+	return static_cast<uint64_t>(end - start);
+}
+
+} // namespace
+#endif
+
 void PointerTable::populate(const ReflectedVariable &reflectedVariable, bool needsSerialization)
 {
-	if (!hasPointer(reflectedVariable)) {
+	// Objects are visited depth-first using an explicit stack rather than recursion so that long chains of
+	// pointers (e.g. linked lists) can't overflow the call stack. Children are pushed in reverse so that they
+	// are visited (and assigned table indices) in member order.
+	std::vector<PendingObject> stack;
+	std::vector<PendingObject> children;
+	stack.push_back({ reflectedVariable, needsSerialization });
+
+	while (!stack.empty()) {
+		PendingObject object = stack.back();
+		stack.pop_back();
+
 		// Add this object's instance to the table.
-		addPointer(reflectedVariable, needsSerialization);
+		bool added = false;
+		addPointer(object.variable, object.needsSerialization, added);
 
-		if (reflectedVariable.instanceData() == nullptr) {
-			// No need to keep processing this type, it is null.
-			return;
+		if (!added || object.variable.instanceData() == nullptr) {
+			// No need to keep processing this type, it has already been visited or is null.
+			continue;
 		}
 
-		// Loop over each of this member's variables and add them to the table using a depth-first
-		// recursive call.
-		const ReflectionData *reflectionData = reflectedVariable.reflectionData();
-        for (auto &member : reflectionData->members()) {
-			// Only add objects who also have data members.
-			if (member->reflectionData()->hasDataMembers() || member->isPointer()) {
-				void *offsetData = pointerOffset(reflectedVariable.instanceData(), member->offset());
-				ReflectedVariable memberVariable(member->reflectionData(), offsetData);
-				if (member->isPointer()) {
-					void *pointerData = &(*(memberVariable.value<char *>()));
-					ReflectedVariable resolvedPointer(member->reflectionData(), pointerData);
-					
-					// Tell the serialization code that this variable needs to be manually serialized
-					// as we don't have direct access to it under the current object.
-					populate(resolvedPointer, true);
-				} else {
-					populate(memberVariable, false);
-				}
+		children.clear();
+		populateMembers(object.variable, object.variable.reflectionData(), children);
+		stack.insert(stack.end(), children.rbegin(), children.rend());
+	}
+}
+
+void PointerTable::reserve(size_t objectCount)
+{
+	m_dataTable.reserve(objectCount);
+	m_lookupTable.reserve(objectCount);
+}
+
+void PointerTable::populateMembers(const ReflectedVariable &reflectedVariable, const ReflectionData *reflectionData, std::vector<PendingObject> &children)
+{
+	// Members inherited from a parent type are part of this object as well.
+	if (reflectionData->hasParent()) {
+		populateMembers(reflectedVariable, reflectionData->parent(), children);
+	}
+
+	// Gather each of this object's member variables which need to be added to the table.
+	for (auto &member : reflectionData->members()) {
+		const ReflectionData *memberData = member->reflectionData();
+		if (member->isPointer()) {
+			void *offsetData = pointerOffset(reflectedVariable.instanceData(), member->offset());
+			ReflectedVariable memberVariable(memberData, offsetData);
+			void *pointerData = &(*(memberVariable.value<char *>()));
+			ReflectedVariable resolvedPointer(memberData, pointerData);
+
+			// Tell the serialization code that this variable needs to be manually serialized
+			// as we don't have direct access to it under the current object.
+			children.push_back({ resolvedPointer, true });
+		} else if (memberData->isContainer()) {
+			for (size_t ii = 0; ii < member->size(); ii += memberData->size()) {
+				populateContainer(pointerOffset(reflectedVariable.instanceData(), member->offset() + ii), memberData, children);
+			}
+		} else if (memberData->hasDataMembers()) { // Only add objects who also have data members.
+			// Every element of an array is its own object.
+			for (size_t ii = 0; ii < member->size(); ii += memberData->size()) {
+				void *offsetData = pointerOffset(reflectedVariable.instanceData(), member->offset() + ii);
+				ReflectedVariable memberVariable(memberData, offsetData);
+				children.push_back({ memberVariable, false });
 			}
 		}
 	}
 }
 
+void PointerTable::populateContainer(void *container, const ReflectionData *containerData, std::vector<PendingObject> &children)
+{
+	const ContainerInfo &info = *containerData->container();
+	info.forEachElement(container, [&](const void *, void *element) {
+		if (info.elementIsPointer) {
+			ReflectedVariable resolvedPointer(info.element, *static_cast<void **>(element));
+			children.push_back({ resolvedPointer, true });
+		} else if (info.element->isContainer()) {
+			populateContainer(element, info.element, children);
+		} else if (info.element->hasDataMembers()) {
+			// Elements are objects of their own, just like the elements of an array.
+			children.push_back({ ReflectedVariable(info.element, element), false });
+		}
+	});
+}
+
 const ReflectedVariable &PointerTable::pointer(TableIndex index)
 {
 	assert(index >= 0 && index < m_dataTable.size());
 	return m_dataTable[index].variable;
 }
 
+void PointerTable::setPointer(TableIndex index, const ReflectedVariable &variable)
+{
+	assert(index < m_dataTable.size());
+	m_dataTable[index].variable = variable;
+}
+
 PointerTable::TableIndex PointerTable::index(const ReflectedVariable &variable) const
 {
 	PointerAddress address = reinterpret_cast<PointerAddress>(variable.instanceData());
-	LookupTable::const_iterator iter = m_lookupTable.find(address);
-	
-	assert(iter != m_lookupTable.end());
-
-	// Look though the possible entires at this address to match up the typename to the passed
-	// in variable type.
-	const std::string &typeName = variable.reflectionData()->name();
-    for (auto &object : iter->second) {
-        if (object.reflectionData->name() == typeName) {
-            return object.tableIndex;
-        }
-    }
+	TableIndex index = m_lookupTable.find(address, variable.reflectionData());
 
-	// Shouldn't ever get here.
-	assert(0);
-	return static_cast<TableIndex>(-1);
+	// Every object being serialized should have been added by populate().
+	assert(index != LookupTable::kNotFound);
+	return index;
+}
+
+PointerTable::TableIndex PointerTable::index(const ReflectedVariable &variable, TableIndex hint) const
+{
+	if (hint < m_dataTable.size()) {
+		const ReflectedVariable &candidate = m_dataTable[hint].variable;
+		if (candidate.instanceData() == variable.instanceData() && candidate.reflectionData() == variable.reflectionData()) {
+			return hint;
+		}
+	}
+
+	return index(variable);
+}
+
+void PointerTable::serialize(std::ostream &stream, SerializationFormat format, ThreadPool *pool)
+{
+	// A single thread can't do better than the sequential path.
+	if (pool != nullptr && pool->threadCount() == 1) {
+		pool = nullptr;
+	}
+
+	switch (format) {
+		case SerializationFormat::Binary:
+			serializeBinary(stream, pool);
+			break;
+
+		case SerializationFormat::Columnar:
+			serializeColumnar(stream);
+			break;
+
+		default:
+			serializeText(stream, pool);
+			break;
+	}
 }
 
-void PointerTable::serialize(std::ostream &stream)
+void PointerTable::deserialize(std::istream &stream, SerializationFormat format, Allocator *allocator, ThreadPool *pool)
+{
+	if (pool != nullptr && pool->threadCount() == 1) {
+		pool = nullptr;
+	}
+
+	// The text and columnar formats can only be read sequentially.
+	switch (format) {
+		case SerializationFormat::Binary:
+			deserializeBinary(stream, allocator, pool);
+			break;
+
+		case SerializationFormat::Columnar:
+			deserializeColumnar(stream, allocator);
+			break;
+
+		default:
+			deserializeText(stream, allocator);
+			break;
+	}
+
+	patchPointers();
+}
+
+void PointerTable::serializeText(std::ostream &stream, ThreadPool *pool)
 {
 	// First write out the size of the table.
-	stream << m_dataTable.size() << std::endl;
+	text::writeValue(stream, m_dataTable.size(), '\n');
 
-	for (size_t ii = 0; ii < m_dataTable.size(); ++ii) {
-		// Only serialize this object if it won't be serialized by some other object (is a child
-		// of an object already being serialized).
-		if (m_dataTable[ii].needsSerialization) {
-			//stream << std::endl; 
-			const ReflectionData *reflectionData = m_dataTable[ii].variable.reflectionData();
-			if (reflectionData->hasParent()) {
-				// Write out the name of this type (so that the deserializer knows what type that any base classes
-				// belong to).
-				stream << "(" << reflectionData->name() << ") ";
-			}
+	if (pool == nullptr) {
+		for (size_t ii = 0; ii < m_dataTable.size(); ++ii) {
+			serializeTextRecord(stream, ii);
+		}
+	} else {
+		// Records are written to a buffer per range which are then appended to the stream in order. The buffers
+		// take on the formatting of the destination stream so the output matches the single threaded path.
+		for (size_t waveStart = 0; waveStart < m_dataTable.size(); waveStart += kRecordsPerWave) {
+			size_t waveSize = std::min(kRecordsPerWave, m_dataTable.size() - waveStart);
+			size_t rangeCount = pool->threadCount() * 4;
+			size_t rangeSize = (waveSize + rangeCount - 1) / rangeCount;
 
-			const ReflectedVariable *tableVariable = &(m_dataTable[ii].variable);
+			std::vector<std::ostringstream> buffers(rangeCount);
+			pool->parallelFor(rangeCount, 1, [&](size_t begin, size_t end) {
+				for (size_t range = begin; range < end; ++range) {
+					std::ostringstream &buffer = buffers[range];
+					buffer.copyfmt(stream);
+					size_t first = waveStart + range * rangeSize;
+					size_t last = std::min(waveStart + waveSize, first + rangeSize);
+					for (size_t ii = first; ii < last; ++ii) {
+						serializeTextRecord(buffer, ii);
+					}
+				}
+			});
 
-			// This function will auto-serialize all objects contained within the current object unless
-			// they are only associated via pointers. In that case, only the index into the table will
-			// be written.
-			tableVariable->reflectionData()->serialize(tableVariable, stream, *this);
+			for (auto &buffer : buffers) {
+				stream << buffer.str();
+			}
 		}
 	}
 
 	stream.flush();
 }
 
-void PointerTable::deserialize(std::istream &stream)
+void PointerTable::serializeTextRecord(std::ostream &stream, TableIndex index)
+{
+	// Only serialize this object if it won't be serialized by some other object (is a child
+	// of an object already being serialized).
+	if (!m_dataTable[index].needsSerialization) {
+		return;
+	}
+
+	CARL_INSTRUMENT_START(timer);
+#if CARL_INSTRUMENTATION
+	std::streampos start = stream.tellp();
+#endif
+
+	const ReflectionData *reflectionData = m_dataTable[index].variable.reflectionData();
+	if (reflectionData->hasParent()) {
+		// Write out the name of this type (so that the deserializer knows what type that any base classes
+		// belong to).
+		stream << "(" << reflectionData->name() << ") ";
+	}
+
+	const ReflectedVariable *tableVariable = &(m_dataTable[index].variable);
+
+	// This function will auto-serialize all objects contained within the current object unless
+	// they are only associated via pointers. In that case, only the index into the table will
+	// be written.
+	tableVariable->reflectionData()->serialize(tableVariable, stream, *this);
+
+	CARL_INSTRUMENT_WRITE(reflectionData, timer, streamDistance(start, stream.tellp()));
+}
+
+void PointerTable::deserializeText(std::istream &stream, Allocator *allocator)
 {
 	// The first thing in the stream should be the size of the pointer table.
 	size_t tableSize = 0;
-	stream >> tableSize;
+	text::readValue(stream, tableSize);
 	assert(tableSize > 0);
 
 	m_dataTable.resize(tableSize);
+	prepareAllocator(allocator, 0);
 
 	std::string streamInput;
+	std::string recordType;
 
 	ReflectionDataManager &manager = ReflectionDataManager::instance();
 
@@ -122,134 +296,1400 @@ void PointerTable::deserialize(std::istream &stream)
 	stream.ignore(256, '\n');
 
 	while (stream.peek() > 0) { // Valid characters have an ascii value > 0.
+		CARL_INSTRUMENT_START(timer);
+#if CARL_INSTRUMENTATION
+		std::streampos start = stream.tellg();
+#endif
+
 		// See if there is a derived type that we're about to read in.
 		bool inheritedObject = false;
 		if (stream.peek() == '(') {
 			// Read in the name of the derived type.
-			stream >> streamInput;
+			text::readToken(stream, streamInput);
 
 			// The name will have surrounding () symbols, get rid of them.
-			streamInput = streamInput.substr(1, streamInput.length() - 2);
+			streamInput.pop_back();
+			streamInput.erase(0, 1);
 
 			inheritedObject = true;
 		}
 
-		// Save off this position in the stream so that the deserialization code and read it again.
-		std::streamoff streamPosition = stream.tellg();
-
 		// Read in the table index for this variable.
-		TableIndex index;
-		stream >> index;
+		TableIndex index = 0;
+		text::readValue(stream, index);
 		assert(index >= 0 && index < tableSize);
 
-		// If this isn't a derived type, just read in its name and start working with it.
+		// Read in the type. For derived types this is the name of the base-most type which starts the record.
+		text::readToken(stream, recordType);
 		if (!inheritedObject) {
-			// Read in the type.
-			stream >> streamInput;
+			streamInput = recordType;
 		}
 
 		const ReflectionData *reflectionData = manager.reflectionData(streamInput);
 		assert(reflectionData);
 
 		// Allocate the space for this type.
-		void *instanceData = reflectionData->allocateInstance();
-		ReflectedVariable variable(reflectionData, static_cast<void *>(instanceData));
-
-		// Reset the stream position before moving on so that the reflection deserialization code can
-		// read that info as well.
-		stream.seekg(streamPosition);
+		ReflectedVariable variable = createInstance(reflectionData);
 
-		// Allow this variable to deserialize itself.
-		reflectionData->deserialize(&variable, stream, *this, false);
+		// Allow this variable to deserialize itself. The index and type that start the record have already been
+		// consumed, so the stream never needs to be rewound.
+		reflectionData->deserialize(&variable, stream, *this, false, &index);
 
 		// Eat the newline character.
 		stream.ignore(256, '\n');
+
+		CARL_INSTRUMENT_READ(reflectionData, timer, streamDistance(start, stream.tellg()));
 	} 
+}
 
-    for (auto &pointer : m_pointersToPatch) {
-        ReflectedVariable *tablePointer = &(m_dataTable[pointer.index].variable);
+void PointerTable::serializeBinary(std::ostream &stream, ThreadPool *pool)
+{
+	// Describe each type that has a record in the stream, along with everything its records are made of, so
+	// that readers whose types have changed since can still decode them. Records refer to their type by id.
+	StreamSchema schema;
+	std::vector<TableIndex> records;
+	std::vector<uint32_t> typeIds;
+	for (size_t ii = 0; ii < m_dataTable.size(); ++ii) {
+		if (m_dataTable[ii].needsSerialization) {
+			records.push_back(ii);
+			typeIds.push_back(schema.add(m_dataTable[ii].variable.reflectionData()));
+		}
+	}
 
-        // Set the pointer to the proper pointer in the table.
-        pointer.variable.value<void *>() = (void *)tablePointer->instanceData();
-    }
+	BinaryWriter types;
+	schema.write(types);
+
+	BinaryWriter header;
+	header.write(binary::kMagic, sizeof(binary::kMagic));
+	header.write<uint32_t>(binary::kVersion);
+	header.write<uint32_t>(binary::kByteOrder);
+	header.write<uint64_t>(m_dataTable.size());
+	header.write<uint64_t>(records.size());
+	header.write<uint32_t>(static_cast<uint32_t>(schema.size()));
+	header.write<uint64_t>(types.size());
+	header.flush(stream);
+	types.flush(stream);
+
+	// Keep track of how much has been written so that payloads can be aligned.
+	uint64_t offset = header.size() + types.size();
+
+	if (pool == nullptr) {
+		// Each record is staged in memory first so that it can be prefixed with its size.
+		BinaryRecordWriter record;
+		for (size_t ii = 0; ii < records.size(); ++ii) {
+			record.payload.clear();
+			record.subobjects.clear();
+			uint8_t flags = serializeBinaryRecord(records[ii], record);
+			writeBinaryRecord(stream, header, records[ii], typeIds[ii], flags, record, offset);
+		}
+	} else {
+		// Records only refer to each other by table index so they can be encoded independently. Payload padding
+		// depends on everything written before a record though, so the encoded records are written out in order.
+		std::vector<BinaryRecordWriter> encoded;
+		std::vector<uint8_t> flags;
+		for (size_t waveStart = 0; waveStart < records.size(); waveStart += kRecordsPerWave) {
+			size_t waveSize = std::min(kRecordsPerWave, records.size() - waveStart);
+			encoded.resize(waveSize);
+			flags.resize(waveSize);
+
+			pool->parallelFor(waveSize, 0, [&](size_t begin, size_t end) {
+				for (size_t ii = begin; ii < end; ++ii) {
+					encoded[ii].payload.clear();
+					encoded[ii].subobjects.clear();
+					flags[ii] = serializeBinaryRecord(records[waveStart + ii], encoded[ii]);
+				}
+			});
+
+			for (size_t ii = 0; ii < waveSize; ++ii) {
+				writeBinaryRecord(stream, header, records[waveStart + ii], typeIds[waveStart + ii], flags[ii], encoded[ii], offset);
+			}
+		}
+	}
+
+	stream.flush();
 }
 
-void PointerTable::addPatchPointer(PointerTable::TableIndex index, ReflectedVariable &pointer)
+uint8_t PointerTable::serializeBinaryRecord(TableIndex index, BinaryRecordWriter &record)
 {
-    PatchPointer pointerToPatch;
-    pointerToPatch.index = index;
-    pointerToPatch.variable = pointer;
-	m_pointersToPatch.push_back(pointerToPatch);
+	const ReflectedVariable *tableVariable = &(m_dataTable[index].variable);
+	if (tableVariable->instanceData() == nullptr) {
+		return binary::kRecordNull;
+	}
+
+	CARL_INSTRUMENT_START(timer);
+	tableVariable->reflectionData()->serializeBinary(tableVariable, record, *this);
+	CARL_INSTRUMENT_WRITE(tableVariable->reflectionData(), timer, record.payload.size() + record.subobjects.size() * sizeof(uint64_t));
+	return 0;
 }
 
-PointerTable::TableIndex PointerTable::addPointer(const ReflectedVariable &pointer, bool needsSerialization)
+void PointerTable::writeBinaryRecord(std::ostream &stream, BinaryWriter &scratch, TableIndex index, uint32_t typeId, uint8_t flags,
+									 const BinaryRecordWriter &record, uint64_t &offset) const
 {
-	PointerAddress address = reinterpret_cast<PointerAddress>(pointer.instanceData());
-	LookupTable::iterator iter = m_lookupTable.find(address);
-	if (iter != m_lookupTable.end()) {
-		// An entry for this address already exists. Make sure we have a matching entry for this type.
-		const std::string &typeName = pointer.reflectionData()->name();
-        for (auto &object : iter->second) {
-			if (object.reflectionData->name() == typeName) {
-				// This pointer already exists in the table, return its index.
-				TableIndex index = object.tableIndex;
-
-				// If this pointer already exists and also wants to be serialized, update its
-				// serialization status. There may be the case where the pointer does not need
-				// to be serialized anymore as what it points to has already been serialized.
-				if (m_dataTable[index].needsSerialization == true) {
-					m_dataTable[index].needsSerialization = needsSerialization;
+	scratch.clear();
+	writeBinaryRecordHeader(scratch, m_dataTable[index].variable.reflectionData(), index, typeId, flags, record, offset);
+	scratch.flush(stream);
+	record.payload.flush(stream);
+}
+
+void PointerTable::writeBinaryRecordHeader(BinaryWriter &writer, const ReflectionData *reflectionData, TableIndex index, uint32_t typeId,
+										   uint8_t flags, const BinaryRecordWriter &record, uint64_t &offset)
+{
+	static const char kPadding[256] = {};
+
+	// Pad the payload out to the alignment of its type.
+	size_t headerSize = sizeof(uint64_t) + binary::kRecordHeaderSize + record.subobjects.size() * sizeof(uint64_t);
+	size_t alignment = reflectionData->alignment();
+	assert(alignment <= sizeof(kPadding));
+	uint8_t padding = static_cast<uint8_t>((alignment - ((offset + headerSize) % alignment)) % alignment);
+
+	uint64_t recordSize = headerSize - sizeof(uint64_t) + padding + record.payload.size();
+
+	writer.write<uint64_t>(recordSize);
+	writer.write<uint32_t>(typeId);
+	writer.write<uint8_t>(flags);
+	writer.write<uint8_t>(padding);
+	writer.write<uint64_t>(index);
+	writer.write<uint32_t>(static_cast<uint32_t>(record.subobjects.size()));
+	writer.write(record.subobjects.data(), record.subobjects.size() * sizeof(uint64_t));
+	writer.write(kPadding, padding);
+
+	offset += sizeof(uint64_t) + recordSize;
+}
+
+namespace {
+
+///
+/// Gathers streamed data into chunks of a fixed size and hands each one to a sink as soon as it is full.
+///
+class ChunkWriter
+{
+public:
+	ChunkWriter(const StreamSink &sink, size_t chunkSize) :
+		m_sink(sink),
+		m_chunkSize(chunkSize)
+	{
+		assert(chunkSize > 0);
+		m_chunk.reserve(chunkSize);
+	}
+
+	void write(const char *data, size_t size)
+	{
+		while (size > 0) {
+			// Whole chunks don't need to be copied when nothing is waiting to go out.
+			if (m_chunk.empty() && size >= m_chunkSize) {
+				m_sink(data, m_chunkSize);
+				data += m_chunkSize;
+				size -= m_chunkSize;
+				continue;
+			}
+
+			size_t count = std::min(size, m_chunkSize - m_chunk.size());
+			m_chunk.insert(m_chunk.end(), data, data + count);
+			data += count;
+			size -= count;
+
+			if (m_chunk.size() == m_chunkSize) {
+				m_sink(m_chunk.data(), m_chunk.size());
+				m_chunk.clear();
+			}
+		}
+	}
+
+	inline void write(const BinaryWriter &writer) { write(writer.data(), writer.size()); }
+
+	///
+	/// Hand whatever is left over to the sink.
+	///
+	void finish()
+	{
+		if (!m_chunk.empty()) {
+			m_sink(m_chunk.data(), m_chunk.size());
+			m_chunk.clear();
+		}
+	}
+
+private:
+	const StreamSink &m_sink;
+	size_t            m_chunkSize = 0;
+	std::vector<char> m_chunk;
+};
+
+} // namespace
+
+void PointerTable::serializeStreaming(const ReflectedVariable &root, const StreamSink &sink, size_t chunkSize)
+{
+	assert(m_dataTable.empty() && m_lookupTable.size() == 0);
+
+	ChunkWriter output(sink, chunkSize);
+	BinaryWriter scratch;
+	scratch.write(binary::kStreamMagic, sizeof(binary::kStreamMagic));
+	scratch.write<uint32_t>(binary::kStreamVersion);
+	scratch.write<uint32_t>(binary::kByteOrder);
+	output.write(scratch);
+
+	// Keep track of how much has been written so that payloads can be aligned.
+	uint64_t offset = scratch.size();
+
+	// Besides the pending objects, only the lookup table is kept: it hands out indices in the order objects are
+	// found and is all the record encoders need (see index()). Records are written depth-first as they are popped
+	// off the pending stack.
+	StreamSchema schema;
+	size_t typesWritten = 0;
+	TableIndex tableSize = 0;
+	uint64_t recordCount = 0;
+
+	std::vector<ReflectedVariable> pending;
+	std::vector<ReflectedVariable> nested;
+	std::vector<ReflectedVariable> discovered;
+	std::vector<PendingObject> children;
+	std::unordered_set<TableIndex> queued; // Indices of the objects on the pending stack still to be written.
+	BinaryRecordWriter record;
+	BinaryWriter types;
+
+	bool added = false;
+	m_lookupTable.insert(reinterpret_cast<PointerAddress>(root.instanceData()), root.reflectionData(), tableSize++, added);
+	pending.push_back(root);
+	queued.insert(0);
+
+	while (!pending.empty()) {
+		ReflectedVariable variable = pending.back();
+		pending.pop_back();
+
+		// Objects which turned out to be nested in an object written since are written with that object.
+		TableIndex recordIndex = index(variable);
+		if (queued.erase(recordIndex) == 0) {
+			continue;
+		}
+
+		// Everything the record refers to needs an index before it can be encoded. Nested objects are part of
+		// the record and are walked right away, pointed to objects which haven't been seen yet are queued to be
+		// written as records of their own.
+		discovered.clear();
+		if (variable.instanceData() != nullptr) {
+			nested.push_back(variable);
+		}
+
+		while (!nested.empty()) {
+			ReflectedVariable object = nested.back();
+			nested.pop_back();
+
+			children.clear();
+			populateMembers(object, object.reflectionData(), children);
+			for (auto &child : children) {
+				PointerAddress address = reinterpret_cast<PointerAddress>(child.variable.instanceData());
+				TableIndex childIndex = m_lookupTable.insert(address, child.variable.reflectionData(), tableSize, added);
+				if (added) {
+					++tableSize;
 				}
 
-				return index;
+				if (!child.needsSerialization) {
+					// Found through a pointer before, if that record hasn't been written yet this object replaces it.
+					if (!added) {
+						queued.erase(childIndex);
+					}
+					nested.push_back(child.variable);
+				} else if (added) {
+					queued.insert(childIndex);
+					discovered.push_back(child.variable);
+				}
 			}
 		}
+		pending.insert(pending.end(), discovered.rbegin(), discovered.rend());
 
-		// If we got to this point, then that means that this specific type doesn't exist at this address (for example, the first
-		// member variable in a struct). Add it now.
-		TableIndex index = m_dataTable.size();
-		Instance instance(pointer.reflectionData(), index);
-		TableRecord record(pointer, needsSerialization);
-		m_dataTable.push_back(record);
+		// Types are described before the first record which needs them.
+		uint32_t typeId = schema.add(variable.reflectionData());
+		if (schema.size() > typesWritten) {
+			types.clear();
+			schema.write(types, typesWritten);
 
-		iter->second.push_back(instance);
+			scratch.clear();
+			scratch.write<uint8_t>(binary::kStreamTypes);
+			scratch.write<uint32_t>(static_cast<uint32_t>(schema.size() - typesWritten));
+			scratch.write<uint64_t>(types.size());
+			output.write(scratch);
+			output.write(types);
+			offset += scratch.size() + types.size();
+			typesWritten = schema.size();
+		}
 
-		return index;
+		record.payload.clear();
+		record.subobjects.clear();
+		uint8_t flags = binary::kRecordNull;
+		if (variable.instanceData() != nullptr) {
+			CARL_INSTRUMENT_START(timer);
+			variable.reflectionData()->serializeBinary(&variable, record, *this);
+			CARL_INSTRUMENT_WRITE(variable.reflectionData(), timer, record.payload.size() + record.subobjects.size() * sizeof(uint64_t));
+			flags = 0;
+		}
+
+		scratch.clear();
+		scratch.write<uint8_t>(binary::kStreamRecord);
+		scratch.write<uint64_t>(tableSize);
+		offset += scratch.size();
+		writeBinaryRecordHeader(scratch, variable.reflectionData(), recordIndex, typeId, flags, record, offset);
+		output.write(scratch);
+		output.write(record.payload);
+		++recordCount;
+	}
+	assert(queued.empty());
+
+	scratch.clear();
+	scratch.write<uint8_t>(binary::kStreamEnd);
+	scratch.write<uint64_t>(tableSize);
+	scratch.write<uint64_t>(recordCount);
+	output.write(scratch);
+	output.finish();
+
+	m_lookupTable.clear();
+}
+
+void PointerTable::deserializeBinary(std::istream &stream, Allocator *allocator, ThreadPool *pool)
+{
+	// The magic tells streamed data apart, the rest of the fixed portion of the header is read in one go.
+	std::vector<char> buffer(kBinaryFixedHeaderSize);
+	stream.read(buffer.data(), sizeof(binary::kMagic));
+	assert(stream);
+	if (memcmp(buffer.data(), binary::kStreamMagic, sizeof(binary::kStreamMagic)) == 0) {
+		deserializeStreamed(stream, allocator);
+		return;
 	}
 
-	// We don't yet have an entry for this address. Create one and add it to the table.
+	stream.read(buffer.data() + sizeof(binary::kMagic), kBinaryFixedHeaderSize - sizeof(binary::kMagic));
+	assert(stream);
 
-	// First create the Objects list to push into the lookup table.
-	TableIndex index = m_dataTable.size();
-	Instance instance(pointer.reflectionData(), index);
-	Objects objects;
-	objects.push_back(instance);
+	BinaryReader reader(buffer.data(), buffer.size());
+	BinaryHeader header;
+	readBinaryHeader(reader, header);
+	prepareAllocator(allocator, 0);
 
-	// Push the data onto the table record.
-	TableRecord record(pointer, needsSerialization);
-	m_dataTable.push_back(record);
+	// Match the stream's types against the registered types.
+	buffer.resize(header.schemaSize);
+	stream.read(buffer.data(), header.schemaSize);
+	assert(stream);
+	BinaryReader schemaReader(buffer.data(), buffer.size());
+	header.schema.read(schemaReader, header.typeCount);
 
-	m_lookupTable[address] = objects;
-	return index;
+	// Remapped records register their pointers to be patched as they're decoded, which only works on one thread.
+	if (pool != nullptr && header.schema.isIdentical()) {
+		// Records can only be decoded concurrently once they are all in memory. Gather them (including their
+		// size fields) into a single buffer.
+		buffer.clear();
+		for (uint64_t ii = 0; ii < header.recordCount; ++ii) {
+			uint64_t recordSize = 0;
+			stream.read(reinterpret_cast<char *>(&recordSize), sizeof(recordSize));
+			assert(recordSize >= binary::kRecordHeaderSize);
+
+			size_t start = buffer.size();
+			buffer.resize(start + sizeof(recordSize) + recordSize);
+			memcpy(buffer.data() + start, &recordSize, sizeof(recordSize));
+			stream.read(buffer.data() + start + sizeof(recordSize), recordSize);
+			assert(stream);
+		}
+
+		BinaryReader recordsReader(buffer.data(), buffer.size());
+		deserializeBinaryRecords(recordsReader, header, false, false, *pool);
+		return;
+	}
+
+	for (uint64_t ii = 0; ii < header.recordCount; ++ii) {
+		uint64_t recordSize = 0;
+		stream.read(reinterpret_cast<char *>(&recordSize), sizeof(recordSize));
+		assert(recordSize >= binary::kRecordHeaderSize);
+
+		buffer.resize(recordSize);
+		stream.read(buffer.data(), recordSize);
+		assert(stream);
+
+		// The record buffer is reused for the next record so nothing may point into it.
+		BinaryReader recordReader(buffer.data(), buffer.size());
+		deserializeBinaryRecord(recordReader, header, false, false);
+	}
 }
 
-bool PointerTable::hasPointer(const ReflectedVariable &variable) const
+void PointerTable::deserializeStreamed(std::istream &stream, Allocator *allocator)
 {
-	PointerAddress address = reinterpret_cast<PointerAddress>(variable.instanceData());
-	LookupTable::const_iterator iter = m_lookupTable.find(address);
+	uint32_t version = 0;
+	uint32_t byteOrder = 0;
+	stream.read(reinterpret_cast<char *>(&version), sizeof(version));
+	stream.read(reinterpret_cast<char *>(&byteOrder), sizeof(byteOrder));
+	assert(stream);
+	assert(version == binary::kStreamVersion);
+	assert(byteOrder == binary::kByteOrder);
+	(void)version;
+	(void)byteOrder;
+
+	BinaryHeader header;
+	prepareAllocator(allocator, 0);
+
+	// Objects created per record (position in m_allocatedObjects and table index), to find those which were
+	// replaced by a nested object afterwards.
+	std::vector<std::pair<size_t, TableIndex>> createdObjects;
+	std::vector<char> buffer;
+
+	for (bool finished = false; !finished;) {
+		uint8_t block = 0;
+		stream.read(reinterpret_cast<char *>(&block), sizeof(block));
+		assert(stream);
+
+		switch (block) {
+			case binary::kStreamTypes:
+			{
+				uint32_t typeCount = 0;
+				uint64_t typesSize = 0;
+				stream.read(reinterpret_cast<char *>(&typeCount), sizeof(typeCount));
+				stream.read(reinterpret_cast<char *>(&typesSize), sizeof(typesSize));
+				buffer.resize(typesSize);
+				stream.read(buffer.data(), typesSize);
+				assert(stream);
+
+				BinaryReader typesReader(buffer.data(), buffer.size());
+				header.schema.read(typesReader, typeCount);
+				header.typeCount += typeCount;
+				break;
+			}
+
+			case binary::kStreamRecord:
+			{
+				uint64_t tableSize = 0;
+				uint64_t recordSize = 0;
+				stream.read(reinterpret_cast<char *>(&tableSize), sizeof(tableSize));
+				stream.read(reinterpret_cast<char *>(&recordSize), sizeof(recordSize));
+				assert(recordSize >= binary::kRecordHeaderSize);
+				if (tableSize > m_dataTable.size()) {
+					m_dataTable.resize(tableSize);
+				}
+
+				buffer.resize(recordSize);
+				stream.read(buffer.data(), recordSize);
+				assert(stream);
+
+				size_t allocated = m_allocatedObjects.size();
+				BinaryReader recordReader(buffer.data(), buffer.size());
+				TableIndex index = deserializeBinaryRecord(recordReader, header, false, false);
+				if (m_allocatedObjects.size() > allocated) {
+					createdObjects.push_back({ allocated, index });
+				}
+				++header.recordCount;
+				break;
+			}
+
+			case binary::kStreamEnd:
+			{
+				uint64_t tableSize = 0;
+				uint64_t recordCount = 0;
+				stream.read(reinterpret_cast<char *>(&tableSize), sizeof(tableSize));
+				stream.read(reinterpret_cast<char *>(&recordCount), sizeof(recordCount));
+				assert(stream);
+				assert(tableSize >= m_dataTable.size() && recordCount == header.recordCount);
+				m_dataTable.resize(tableSize);
+				finished = true;
+				break;
+			}
+
+			default:
+				assert(false && "Unknown block in streamed binary data");
+				return;
+		}
+	}
+
+	// Pointers are patched before the replaced objects (which hold some of them) are destroyed.
+	patchPointers();
+	m_pointersToPatch.clear();
+
+	std::vector<bool> replaced(m_allocatedObjects.size(), false);
+	for (auto &created : createdObjects) {
+		const ReflectedVariable &object = m_allocatedObjects[created.first];
+		if (m_dataTable[created.second].variable.instanceData() != object.instanceData()) {
+			m_allocator->destroyInstance(object.reflectionData(), const_cast<void *>(object.instanceData()));
+			replaced[created.first] = true;
+		}
+	}
+
+	size_t kept = 0;
+	for (size_t ii = 0; ii < m_allocatedObjects.size(); ++ii) {
+		if (!replaced[ii]) {
+			m_allocatedObjects[kept++] = m_allocatedObjects[ii];
+		}
+	}
+	m_allocatedObjects.resize(kept);
+}
+
+void PointerTable::serializeColumnar(std::ostream &stream)
+{
+	static const char kPadding[binary::kColumnAlignment] = {};
+
+	// Group the records by type, in the order the types are first met. Null records have no columns to add to.
+	struct Group
+	{
+		uint32_t                  typeId = 0; ///< Stream type id of the records.
+		std::vector<TableIndex>   records;    ///< Table indices of the records.
+		std::vector<const void *> instances;  ///< Objects of the records.
+	};
+
+	StreamSchema schema;
+	std::vector<Group> groups;
+	std::vector<std::pair<uint32_t, TableIndex>> nullRecords;
+	constexpr size_t kNoGroup = static_cast<size_t>(-1);
+	std::vector<size_t> groupOfType; // Schema type ids are handed out consecutively.
+	for (size_t ii = 0; ii < m_dataTable.size(); ++ii) {
+		if (!m_dataTable[ii].needsSerialization) {
+			continue;
+		}
+
+		const ReflectedVariable &variable = m_dataTable[ii].variable;
+		uint32_t typeId = schema.add(variable.reflectionData());
+		if (variable.instanceData() == nullptr) {
+			nullRecords.push_back({ typeId, ii });
+			continue;
+		}
+
+		if (typeId >= groupOfType.size()) {
+			groupOfType.resize(schema.size(), kNoGroup);
+		}
+		if (groupOfType[typeId] == kNoGroup) {
+			groupOfType[typeId] = groups.size();
+			groups.emplace_back();
+			groups.back().typeId = typeId;
+		}
+		Group &group = groups[groupOfType[typeId]];
+		group.records.push_back(ii);
+		group.instances.push_back(variable.instanceData());
+	}
+
+	uint64_t recordCount = nullRecords.size();
+	for (auto &group : groups) {
+		recordCount += group.records.size();
+	}
+
+	BinaryWriter types;
+	schema.write(types);
+
+	BinaryWriter header;
+	header.write(binary::kColumnarMagic, sizeof(binary::kColumnarMagic));
+	header.write<uint32_t>(binary::kColumnarVersion);
+	header.write<uint32_t>(binary::kByteOrder);
+	header.write<uint64_t>(m_dataTable.size());
+	header.write<uint64_t>(recordCount);
+	header.write<uint32_t>(static_cast<uint32_t>(schema.size()));
+	header.write<uint64_t>(types.size());
+	header.flush(stream);
+	types.flush(stream);
+	uint64_t offset = header.size() + types.size();
+
+	header.clear();
+	header.write<uint64_t>(nullRecords.size());
+	for (auto &nullRecord : nullRecords) {
+		header.write<uint32_t>(nullRecord.first);
+		header.write<uint64_t>(nullRecord.second);
+	}
+	header.write<uint32_t>(static_cast<uint32_t>(groups.size()));
+	header.flush(stream);
+	offset += header.size();
+
+	// Columns are encoded into the same record, their positions are kept to lay them out aligned.
+	BinaryRecordWriter record;
+	std::vector<ReflectionData::ColumnSlice> columns;
+	for (auto &group : groups) {
+		const ReflectionData *reflectionData = m_dataTable[group.records.front()].variable.reflectionData();
+		const SerializationPlan &plan = reflectionData->columnPlan();
+
+		record.payload.clear();
+		record.subobjects.clear();
+		for (const void *instance : group.instances) {
+			for (auto &object : plan.objects) {
+				record.subobjects.push_back(index(ReflectedVariable(object.data, pointerOffset(instance, object.offset))));
+			}
+		}
+
+		reflectionData->serializeColumnsBinary(group.instances, record, columns, *this);
+
+		// Everything up to the first column, which starts aligned.
+		size_t headerSize = sizeof(uint64_t) + 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t) +
+		                    (group.records.size() + record.subobjects.size()) * sizeof(uint64_t);
+		size_t padding = (binary::kColumnAlignment - (offset + headerSize) % binary::kColumnAlignment) % binary::kColumnAlignment;
+		uint64_t groupSize = headerSize + padding - sizeof(uint64_t);
+		for (auto &column : columns) {
+			groupSize += 2 * sizeof(uint64_t) + column.size + (binary::kColumnAlignment - column.size % binary::kColumnAlignment) % binary::kColumnAlignment;
+		}
+
+		header.clear();
+		header.write<uint64_t>(groupSize);
+		header.write<uint32_t>(group.typeId);
+		header.write<uint32_t>(static_cast<uint32_t>(plan.ops.size()));
+		header.write<uint64_t>(group.records.size());
+		header.write<uint64_t>(record.subobjects.size());
+		for (TableIndex recordIndex : group.records) {
+			header.write<uint64_t>(recordIndex);
+		}
+		header.write(record.subobjects.data(), record.subobjects.size() * sizeof(uint64_t));
+		header.write(kPadding, padding);
+		header.flush(stream);
+
+		for (auto &column : columns) {
+			uint64_t size = column.size;
+			stream.write(reinterpret_cast<const char *>(&size), sizeof(size));
+			stream.write(kPadding, sizeof(uint64_t));
+			stream.write(record.payload.data() + column.offset, column.size);
+			stream.write(kPadding, (binary::kColumnAlignment - column.size % binary::kColumnAlignment) % binary::kColumnAlignment);
+		}
+
+		offset += sizeof(uint64_t) + groupSize;
+	}
+
+	stream.flush();
+}
+
+void PointerTable::deserializeColumnar(std::istream &stream, Allocator *allocator)
+{
+	BinaryHeader header;
+	std::vector<char> buffer(kBinaryFixedHeaderSize);
+	stream.read(buffer.data(), buffer.size());
+	assert(stream);
+
+	BinaryReader reader(buffer.data(), buffer.size());
+	char magic[sizeof(binary::kColumnarMagic)];
+	reader.read(magic, sizeof(magic));
+	assert(memcmp(magic, binary::kColumnarMagic, sizeof(magic)) == 0);
+	uint32_t version = reader.read<uint32_t>();
+	assert(version == binary::kColumnarVersion);
+	uint32_t byteOrder = reader.read<uint32_t>();
+	assert(byteOrder == binary::kByteOrder);
+	(void)version;
+	(void)byteOrder;
+
+	m_dataTable.resize(reader.read<uint64_t>());
+	header.recordCount = reader.read<uint64_t>();
+	header.typeCount = reader.read<uint32_t>();
+	header.schemaSize = reader.read<uint64_t>();
+	uint64_t offset = kBinaryFixedHeaderSize + header.schemaSize;
+
+	buffer.resize(header.schemaSize);
+	stream.read(buffer.data(), buffer.size());
+	assert(stream);
+	BinaryReader schemaReader(buffer.data(), buffer.size());
+	header.schema.read(schemaReader, header.typeCount);
+
+	prepareAllocator(allocator, 0);
+
+	uint64_t nullCount = 0;
+	stream.read(reinterpret_cast<char *>(&nullCount), sizeof(nullCount));
+	for (uint64_t ii = 0; ii < nullCount; ++ii) {
+		uint32_t typeId = 0;
+		uint64_t index = 0;
+		stream.read(reinterpret_cast<char *>(&typeId), sizeof(typeId));
+		stream.read(reinterpret_cast<char *>(&index), sizeof(index));
+		assert(stream && typeId < header.schema.size() && index < m_dataTable.size());
+		if (header.schema.localType(typeId) != nullptr) {
+			setPointer(index, ReflectedVariable(header.schema.localType(typeId), nullptr));
+		}
+	}
+
+	uint32_t groupCount = 0;
+	stream.read(reinterpret_cast<char *>(&groupCount), sizeof(groupCount));
+	assert(stream);
+	offset += sizeof(uint64_t) + nullCount * (sizeof(uint32_t) + sizeof(uint64_t)) + sizeof(uint32_t);
+
+	std::vector<void *> instances;
+	std::vector<BinaryReader> columns;
+	for (uint32_t group = 0; group < groupCount; ++group) {
+		uint64_t groupSize = 0;
+		stream.read(reinterpret_cast<char *>(&groupSize), sizeof(groupSize));
+		buffer.resize(groupSize);
+		stream.read(buffer.data(), buffer.size());
+		assert(stream);
 
-	if (iter == m_lookupTable.end()) {
+		BinaryReader groupReader(buffer.data(), buffer.size());
+		uint32_t typeId = groupReader.read<uint32_t>();
+		uint32_t columnCount = groupReader.read<uint32_t>();
+		uint64_t recordCount = groupReader.read<uint64_t>();
+		uint64_t subobjectCount = groupReader.read<uint64_t>();
+		assert(typeId < header.schema.size());
+
+		// The type is gone, so are the members which pointed to it (see StreamSchema).
+		const ReflectionData *reflectionData = header.schema.localType(typeId);
+		offset += sizeof(uint64_t) + groupSize;
+		if (reflectionData == nullptr) {
+			continue;
+		}
+
+		// Columns can't be remapped one at a time, changed types have to go through the binary format.
+		if (!header.schema.isIdentical(typeId)) {
+			clear();
+			stream.setstate(std::ios::failbit);
+			return;
+		}
+		const SerializationPlan &plan = reflectionData->columnPlan();
+		assert(columnCount == plan.ops.size());
+		(void)columnCount;
+
+		BinaryReader indices = groupReader.subReader(recordCount * sizeof(uint64_t));
+		BinaryRecordReader record;
+		record.subobjects = groupReader.subReader(subobjectCount * sizeof(uint64_t));
+
+		instances.clear();
+		for (uint64_t ii = 0; ii < recordCount; ++ii) {
+			ReflectedVariable variable = createInstance(reflectionData);
+			setPointer(indices.read<uint64_t>(), variable);
+			instances.push_back(const_cast<void *>(variable.instanceData()));
+
+			for (auto &object : plan.objects) {
+				setPointer(record.subobjects.read<uint64_t>(), ReflectedVariable(object.data, pointerOffset(instances.back(), object.offset)));
+			}
+		}
+
+		size_t consumed = groupSize - groupReader.remaining();
+		size_t groupStart = offset - groupSize;
+		groupReader.skip((binary::kColumnAlignment - (groupStart + consumed) % binary::kColumnAlignment) % binary::kColumnAlignment);
+
+		columns.clear();
+		for (size_t column = 0; column < plan.ops.size(); ++column) {
+			uint64_t columnSize = groupReader.read<uint64_t>();
+			groupReader.skip(sizeof(uint64_t));
+			columns.push_back(groupReader.subReader(columnSize));
+			groupReader.skip((binary::kColumnAlignment - columnSize % binary::kColumnAlignment) % binary::kColumnAlignment);
+		}
+
+		reflectionData->deserializeColumnsBinary(instances, columns, record, *this);
+		assert(record.subobjects.atEnd() && groupReader.atEnd());
+	}
+}
+
+void PointerTable::deserializeInPlace(char *data, size_t size, const InPlaceOptions &options)
+{
+	BinaryReader reader(data, size);
+	BinaryHeader header;
+	readBinaryHeader(reader, header);
+
+	// Payloads hold at least as many bytes as most objects need so the size of the data is a good estimate.
+	prepareAllocator(options.allocator, size);
+
+	BinaryReader schemaReader = reader.subReader(header.schemaSize);
+	header.schema.read(schemaReader, header.typeCount);
+
+	if (options.pool != nullptr && options.pool->threadCount() > 1 && header.schema.isIdentical()) {
+		deserializeBinaryRecords(reader, header, true, options.referenceRecords, *options.pool);
+		return;
+	}
+
+	for (uint64_t ii = 0; ii < header.recordCount; ++ii) {
+		uint64_t recordSize = reader.read<uint64_t>();
+		assert(recordSize >= binary::kRecordHeaderSize);
+
+		BinaryReader recordReader = reader.subReader(recordSize);
+		deserializeBinaryRecord(recordReader, header, true, options.referenceRecords);
+	}
+
+	patchPointers();
+}
+
+void PointerTable::deserializeBinaryRecords(BinaryReader &reader, const BinaryHeader &header, bool persistent, bool referenceInPlace, ThreadPool &pool)
+{
+	assert(header.schema.isIdentical());
+
+	// Build an index of where every record lives so that they can be decoded in any order.
+	std::vector<BinaryRecordInfo> records(header.recordCount);
+	for (auto &info : records) {
+		uint64_t recordSize = reader.read<uint64_t>();
+		assert(recordSize >= binary::kRecordHeaderSize);
+
+		BinaryReader recordReader = reader.subReader(recordSize);
+		readBinaryRecordHeader(recordReader, header, persistent, info);
+		info.record.deferPointers = true;
+	}
+
+	// Allocators aren't required to be thread safe so every object is created up front.
+	std::vector<ReflectedVariable> variables(records.size());
+	for (size_t ii = 0; ii < records.size(); ++ii) {
+		if (!placeBinaryRecord(records[ii], referenceInPlace, variables[ii])) {
+			variables[ii] = ReflectedVariable();
+		}
+	}
+
+	// Each record only touches its own object and the table entries of its own nested objects.
+	pool.parallelFor(records.size(), 0, [&](size_t begin, size_t end) {
+		for (size_t ii = begin; ii < end; ++ii) {
+			if (variables[ii].reflectionData() != nullptr) {
+				CARL_INSTRUMENT_START(timer);
+				variables[ii].reflectionData()->deserializeBinary(&variables[ii], records[ii].record, *this);
+				assert(records[ii].record.payload.atEnd() && records[ii].record.subobjects.atEnd());
+				CARL_INSTRUMENT_READ(variables[ii].reflectionData(), timer, records[ii].dataSize);
+			}
+		}
+	});
+
+	// Pointers were left holding table indices which can now be resolved.
+	pool.parallelFor(records.size(), 0, [&](size_t begin, size_t end) {
+		for (size_t ii = begin; ii < end; ++ii) {
+			if (variables[ii].reflectionData() != nullptr) {
+				variables[ii].reflectionData()->patchBinaryPointers(&variables[ii], *this);
+			}
+		}
+	});
+}
+
+void PointerTable::readBinaryHeader(BinaryReader &reader, BinaryHeader &header)
+{
+	char magic[sizeof(binary::kMagic)];
+	reader.read(magic, sizeof(magic));
+	assert(memcmp(magic, binary::kMagic, sizeof(magic)) == 0);
+	uint32_t version = reader.read<uint32_t>();
+	assert(version == binary::kVersion);
+	uint32_t byteOrder = reader.read<uint32_t>();
+	assert(byteOrder == binary::kByteOrder);
+
+	uint64_t tableSize = reader.read<uint64_t>();
+	assert(tableSize > 0);
+	header.recordCount = reader.read<uint64_t>();
+	header.typeCount = reader.read<uint32_t>();
+	header.schemaSize = reader.read<uint64_t>();
+
+	m_dataTable.resize(tableSize);
+}
+
+PointerTable::TableIndex PointerTable::deserializeBinaryRecord(BinaryReader &reader, const BinaryHeader &header, bool persistent, bool referenceInPlace)
+{
+	BinaryRecordInfo info;
+	readBinaryRecordHeader(reader, header, persistent, info);
+
+	ReflectedVariable variable;
+	if (placeBinaryRecord(info, referenceInPlace, variable)) {
+		CARL_INSTRUMENT_START(timer);
+		if (info.remapped) {
+			header.schema.decodeRecord(info.typeId, variable, info.record, *this);
+		} else {
+			variable.reflectionData()->deserializeBinary(&variable, info.record, *this);
+		}
+		assert(info.record.payload.atEnd() && info.record.subobjects.atEnd());
+		CARL_INSTRUMENT_READ(variable.reflectionData(), timer, info.dataSize);
+	}
+
+	return info.index;
+}
+
+void PointerTable::readBinaryRecordHeader(BinaryReader &reader, const BinaryHeader &header, bool persistent, BinaryRecordInfo &info)
+{
+	info.typeId = reader.read<uint32_t>();
+	assert(info.typeId < header.schema.size());
+	info.flags = reader.read<uint8_t>();
+	uint8_t padding = reader.read<uint8_t>();
+	info.index = reader.read<uint64_t>();
+	assert(info.index < m_dataTable.size());
+	uint32_t subobjectCount = reader.read<uint32_t>();
+
+	info.reflectionData = header.schema.localType(info.typeId);
+	info.remapped = !header.schema.isIdentical(info.typeId);
+	if (info.flags & binary::kRecordNull) {
+		return;
+	}
+
+	info.record.subobjects = reader.subReader(subobjectCount * sizeof(uint64_t));
+	reader.skip(padding);
+	info.record.payload = reader;
+	info.dataSize = subobjectCount * sizeof(uint64_t) + reader.remaining();
+	info.record.persistent = persistent;
+}
+
+bool PointerTable::placeBinaryRecord(BinaryRecordInfo &info, bool referenceInPlace, ReflectedVariable &variable)
+{
+	const ReflectionData *reflectionData = info.reflectionData;
+	if (reflectionData == nullptr) {
+		// The type is gone, so are the members which pointed to it (see StreamSchema).
+		return false;
+	}
+
+	if (info.flags & binary::kRecordNull) {
+		setPointer(info.index, ReflectedVariable(reflectionData, nullptr));
 		return false;
 	}
 
-	// We have an entry for this address, make sure that we have a type match as well.
-	const std::string &typeName = variable.reflectionData()->name();
-    for (auto &object : iter->second) {
-        if (object.reflectionData->name() == typeName) {
-            return true;
-        }
+	// Block copyable records are exactly the bytes of the object so, if the memory is going to stick around
+	// and is suitably aligned, the object can be used right where it is.
+	char *payload = const_cast<char *>(info.record.payload.position());
+	if (referenceInPlace && !info.remapped && reflectionData->isBlockCopyable() &&
+		(reinterpret_cast<uintptr_t>(payload) % reflectionData->alignment()) == 0) {
+		assert(info.record.payload.remaining() == reflectionData->size());
+
+		setPointer(info.index, ReflectedVariable(reflectionData, payload));
+		for (auto &object : reflectionData->plan().objects) {
+			setPointer(info.record.subobjects.read<uint64_t>(), ReflectedVariable(object.data, payload + object.offset));
+		}
+		return false;
+	}
+
+	// Allocate the space for this type.
+	variable = createInstance(reflectionData);
+	setPointer(info.index, variable);
+	return true;
+}
+
+ReflectedVariable PointerTable::createInstance(const ReflectionData *reflectionData)
+{
+	ReflectedVariable variable(reflectionData, m_allocator->createInstance(reflectionData));
+	m_allocatedObjects.push_back(variable);
+	return variable;
+}
+
+void PointerTable::prepareAllocator(Allocator *allocator, size_t byteCount)
+{
+	if (allocator == nullptr) {
+		allocator = &HeapAllocator::instance();
+	}
+
+	// Objects created by a previous allocator can't be tracked alongside those of a new one.
+	assert(m_allocatedObjects.empty() || m_allocator == allocator);
+
+	m_allocator = allocator;
+	m_allocator->reserve(m_dataTable.size(), byteCount);
+	m_allocatedObjects.reserve(m_allocatedObjects.size() + m_dataTable.size());
+}
+
+std::string_view PointerTable::keepCharacters(std::string_view characters)
+{
+	if (characters.empty()) {
+		return std::string_view();
+	}
+
+	std::lock_guard<std::mutex> lock(m_charactersMutex);
+	return m_allocator->keepCharacters(characters);
+}
+
+void PointerTable::destroyAllocatedObjects()
+{
+	for (auto &object : m_allocatedObjects) {
+		m_allocator->destroyInstance(object.reflectionData(), const_cast<void *>(object.instanceData()));
+	}
+	m_allocatedObjects.clear();
+}
+
+void PointerTable::clear()
+{
+	destroyAllocatedObjects();
+	m_dataTable.clear();
+	m_lookupTable.clear();
+	m_pointersToPatch.clear();
+}
+
+void PointerTable::clone(PointerTable &target, Allocator *allocator)
+{
+	assert(target.m_dataTable.empty());
+	target.m_dataTable.resize(m_dataTable.size());
+
+	size_t byteCount = 0;
+	for (auto &record : m_dataTable) {
+		if (record.needsSerialization && record.variable.instanceData() != nullptr) {
+			byteCount += record.variable.reflectionData()->size();
+		}
+	}
+	target.prepareAllocator(allocator, byteCount);
+
+	// Records are copied in table order. Nested objects are registered in the target while their record is
+	// copied, pointers are patched once every copy exists.
+	for (size_t ii = 0; ii < m_dataTable.size(); ++ii) {
+		if (!m_dataTable[ii].needsSerialization) {
+			continue;
+		}
+
+		const ReflectedVariable &source = m_dataTable[ii].variable;
+		const ReflectionData *reflectionData = source.reflectionData();
+		if (source.instanceData() == nullptr) {
+			target.m_dataTable[ii] = TableRecord(source, true);
+			continue;
+		}
+
+		ReflectedVariable copy = target.createInstance(reflectionData);
+		target.m_dataTable[ii] = TableRecord(copy, true);
+		reflectionData->clone(&source, &copy, *this, target);
+	}
+
+	target.patchPointers();
+}
+
+uint64_t PointerTable::hash()
+{
+	Hasher hasher;
+	for (size_t ii = 0; ii < m_dataTable.size(); ++ii) {
+		if (!m_dataTable[ii].needsSerialization) {
+			continue;
+		}
+
+		// Each record is identified by its index and type, nested objects are part of the record holding them.
+		const ReflectedVariable &variable = m_dataTable[ii].variable;
+		const std::string &typeName = variable.reflectionData()->name();
+		hasher.add<uint64_t>(ii);
+		hasher.update(typeName.data(), typeName.size());
+
+		if (variable.instanceData() == nullptr) {
+			hasher.add<uint8_t>(binary::kRecordNull);
+			continue;
+		}
+
+		variable.reflectionData()->hash(&variable, hasher, *this);
+	}
+
+	return hasher.digest();
+}
+
+namespace {
+
+///
+/// Members of a type in delta ordinal order (members of parent types first), cached per type.
+///
+using DeltaMembers = std::vector<const ReflectedMember *>;
+using DeltaMemberCache = std::unordered_map<const ReflectionData *, DeltaMembers>;
+
+const DeltaMembers &deltaMembers(const ReflectionData *reflectionData, DeltaMemberCache &cache)
+{
+	auto iter = cache.find(reflectionData);
+	if (iter != cache.end()) {
+		return iter->second;
+	}
+
+	std::vector<const ReflectionData *> types;
+	for (const ReflectionData *type = reflectionData; type != nullptr; type = type->parent()) {
+		types.push_back(type);
+	}
+
+	DeltaMembers &members = cache[reflectionData];
+	for (auto type = types.rbegin(); type != types.rend(); ++type) {
+		members.insert(members.end(), (*type)->members().begin(), (*type)->members().end());
+	}
+	return members;
+}
+
+///
+/// Determine if instances of a type hold objects with their own table entries (directly or within containers).
+///
+bool containsObjects(const ReflectionData *reflectionData)
+{
+	if (reflectionData->isContainer()) {
+		const ContainerInfo &info = *reflectionData->container();
+		return !info.elementIsPointer && containsObjects(info.element);
+	}
+	return reflectionData->hasDataMembers();
+}
+
+///
+/// Determine if decoding an instance of a type over an existing one may move objects which have their own table entries.
+/// Map values are always re-created and the elements of nested containers move when an inner container outgrows its
+/// storage. Vectors of objects keep their elements unless their size changes, which changes the table layout anyway.
+///
+using RelocationCache = std::unordered_map<const ReflectionData *, bool>;
+
+bool relocatesObjects(const ReflectionData *reflectionData, RelocationCache &cache)
+{
+	auto iter = cache.find(reflectionData);
+	if (iter != cache.end()) {
+		return iter->second;
+	}
+
+	// Seed the cache so that recursive types terminate.
+	cache[reflectionData] = false;
+
+	bool relocates = false;
+	if (reflectionData->isContainer()) {
+		const ContainerInfo &info = *reflectionData->container();
+		if (!info.elementIsPointer) {
+			if (!info.isContiguous() || info.element->isContainer()) {
+				relocates = containsObjects(info.element);
+			} else {
+				relocates = relocatesObjects(info.element, cache);
+			}
+		}
+	} else {
+		for (const ReflectionData *type = reflectionData; type != nullptr && !relocates; type = type->parent()) {
+			for (auto &member : type->members()) {
+				if (!member->isPointer() && relocatesObjects(member->reflectionData(), cache)) {
+					relocates = true;
+					break;
+				}
+			}
+		}
+	}
+
+	cache[reflectionData] = relocates;
+	return relocates;
+}
+
+} // namespace
+
+void PointerTable::captureBaseline(DeltaBaseline &baseline)
+{
+	DeltaMemberCache members;
+	baseline.clear();
+	baseline.m_entries.resize(m_dataTable.size());
+
+	BinaryRecordWriter record;
+	for (size_t ii = 0; ii < m_dataTable.size(); ++ii) {
+		const ReflectedVariable &variable = m_dataTable[ii].variable;
+		DeltaBaseline::Entry &entry = baseline.m_entries[ii];
+		entry.type = variable.reflectionData();
+		entry.isRecord = m_dataTable[ii].needsSerialization;
+		entry.isNull = (variable.instanceData() == nullptr);
+		entry.firstMember = baseline.m_members.size();
+		if (!entry.isRecord || entry.isNull) {
+			continue;
+		}
+
+		// Nested objects are encoded as part of the members that hold them, only records are captured.
+		for (auto &member : deltaMembers(entry.type, members)) {
+			record.payload.clear();
+			record.subobjects.clear();
+			ReflectionData::serializeMemberBinary(&variable, member, record, *this);
+
+			DeltaBaseline::Member encoded;
+			encoded.payloadOffset = baseline.m_payload.size();
+			encoded.payloadSize = record.payload.size();
+			encoded.subobjectOffset = baseline.m_subobjects.size();
+			encoded.subobjectCount = record.subobjects.size();
+			baseline.m_members.push_back(encoded);
+
+			baseline.m_payload.insert(baseline.m_payload.end(), record.payload.data(), record.payload.data() + record.payload.size());
+			baseline.m_subobjects.insert(baseline.m_subobjects.end(), record.subobjects.begin(), record.subobjects.end());
+		}
+	}
+}
+
+void PointerTable::serializeDelta(std::ostream &stream, DeltaBaseline &baseline)
+{
+	DeltaMemberCache members;
+	DeltaBaseline current;
+	captureBaseline(current);
+
+	// Table indices only refer to the same objects on both sides if the layout of the table hasn't changed.
+	bool layoutChanged = (baseline.m_entries.size() != current.m_entries.size());
+	for (size_t ii = 0; !layoutChanged && ii < current.m_entries.size(); ++ii) {
+		const DeltaBaseline::Entry &before = baseline.m_entries[ii];
+		const DeltaBaseline::Entry &now = current.m_entries[ii];
+		layoutChanged = (before.type != now.type || before.isRecord != now.isRecord || before.isNull != now.isNull);
+	}
+
+	struct Change
+	{
+		TableIndex index;                    ///< Record the member belongs to.
+		uint32_t ordinal;                    ///< Ordinal of the member.
+		const DeltaBaseline::Member *member; ///< Current state of the member.
+	};
+	std::vector<Change> changes;
+
+	RelocationCache relocation;
+	auto gatherChanges = [&](bool everything) {
+		changes.clear();
+		for (size_t ii = 0; ii < current.m_entries.size(); ++ii) {
+			const DeltaBaseline::Entry &entry = current.m_entries[ii];
+			if (!entry.isRecord || entry.isNull) {
+				continue;
+			}
+
+			const DeltaMembers &typeMembers = deltaMembers(entry.type, members);
+			for (size_t ordinal = 0; ordinal < typeMembers.size(); ++ordinal) {
+				const DeltaBaseline::Member &now = current.m_members[entry.firstMember + ordinal];
+				if (!everything) {
+					const DeltaBaseline::Member &before = baseline.m_members[baseline.m_entries[ii].firstMember + ordinal];
+					bool unchanged = (before.payloadSize == now.payloadSize && before.subobjectCount == now.subobjectCount &&
+									  std::equal(baseline.m_payload.begin() + before.payloadOffset, baseline.m_payload.begin() + before.payloadOffset + before.payloadSize,
+												 current.m_payload.begin() + now.payloadOffset) &&
+									  std::equal(baseline.m_subobjects.begin() + before.subobjectOffset, baseline.m_subobjects.begin() + before.subobjectOffset + before.subobjectCount,
+												 current.m_subobjects.begin() + now.subobjectOffset));
+					if (unchanged) {
+						continue;
+					}
+
+					// Decoding this member may move objects that unchanged members point to, which only a full rewrite can fix.
+					const ReflectedMember *member = typeMembers[ordinal];
+					if (!member->isPointer() && relocatesObjects(member->reflectionData(), relocation)) {
+						return false;
+					}
+				}
+
+				changes.push_back({ ii, static_cast<uint32_t>(ordinal), &now });
+			}
+		}
+		return true;
+	};
+
+	if (layoutChanged || !gatherChanges(false)) {
+		layoutChanged = true;
+		gatherChanges(true);
+	}
+
+	BinaryWriter body;
+
+	// Record types are only needed when the records are listed.
+	std::unordered_map<const ReflectionData *, uint32_t> typeIds;
+	std::vector<const ReflectionData *> types;
+	if (layoutChanged) {
+		for (auto &entry : current.m_entries) {
+			if (entry.isRecord && typeIds.find(entry.type) == typeIds.end()) {
+				typeIds[entry.type] = static_cast<uint32_t>(types.size());
+				types.push_back(entry.type);
+			}
+		}
+	}
+
+	body.write<uint32_t>(static_cast<uint32_t>(types.size()));
+	for (auto &type : types) {
+		body.write<uint32_t>(static_cast<uint32_t>(type->name().length()));
+		body.write(type->name().data(), type->name().length());
+	}
+
+	if (layoutChanged) {
+		uint64_t recordCount = std::count_if(current.m_entries.begin(), current.m_entries.end(), [](const DeltaBaseline::Entry &entry) { return entry.isRecord; });
+		body.write<uint64_t>(recordCount);
+		for (size_t ii = 0; ii < current.m_entries.size(); ++ii) {
+			const DeltaBaseline::Entry &entry = current.m_entries[ii];
+			if (entry.isRecord) {
+				body.write<uint64_t>(ii);
+				body.write<uint32_t>(typeIds[entry.type]);
+				body.write<uint8_t>(entry.isNull ? binary::kRecordNull : 0);
+			}
+		}
+	}
+
+	body.write<uint64_t>(changes.size());
+	for (auto &change : changes) {
+		body.write<uint64_t>(change.index);
+		body.write<uint32_t>(change.ordinal);
+		body.write<uint32_t>(static_cast<uint32_t>(change.member->subobjectCount));
+		body.write<uint64_t>(change.member->payloadSize);
+		body.write(current.m_subobjects.data() + change.member->subobjectOffset, change.member->subobjectCount * sizeof(uint64_t));
+		body.write(current.m_payload.data() + change.member->payloadOffset, change.member->payloadSize);
+	}
+
+	BinaryWriter header;
+	header.write(binary::kDeltaMagic, sizeof(binary::kDeltaMagic));
+	header.write<uint32_t>(binary::kDeltaVersion);
+	header.write<uint32_t>(binary::kByteOrder);
+	header.write<uint8_t>(layoutChanged ? binary::kDeltaLayoutChanged : 0);
+	header.write<uint64_t>(current.m_entries.size());
+	header.write<uint64_t>(body.size());
+	header.flush(stream);
+	body.flush(stream);
+	stream.flush();
+
+	// The current state is the baseline for the next delta.
+	baseline = std::move(current);
+}
+
+void PointerTable::applyDelta(std::istream &stream, Allocator *allocator)
+{
+	std::vector<char> buffer(binary::kDeltaHeaderSize);
+	stream.read(buffer.data(), buffer.size());
+	assert(stream);
+
+	BinaryReader header(buffer.data(), buffer.size());
+	char magic[sizeof(binary::kDeltaMagic)];
+	header.read(magic, sizeof(magic));
+	assert(memcmp(magic, binary::kDeltaMagic, sizeof(magic)) == 0);
+	uint32_t version = header.read<uint32_t>();
+	assert(version == binary::kDeltaVersion);
+	uint32_t byteOrder = header.read<uint32_t>();
+	assert(byteOrder == binary::kByteOrder);
+	(void)version;
+	(void)byteOrder;
+	uint8_t flags = header.read<uint8_t>();
+	uint64_t tableSize = header.read<uint64_t>();
+	uint64_t bodySize = header.read<uint64_t>();
+
+	buffer.resize(bodySize);
+	stream.read(buffer.data(), bodySize);
+	assert(stream);
+	BinaryReader body(buffer.data(), buffer.size());
+
+	ReflectionDataManager &manager = ReflectionDataManager::instance();
+	std::vector<const ReflectionData *> types(body.read<uint32_t>());
+	for (auto &type : types) {
+		uint32_t nameLength = body.read<uint32_t>();
+		assert(body.remaining() >= nameLength);
+		type = manager.reflectionData(std::string(body.position(), nameLength));
+		body.skip(nameLength);
+		assert(type);
+	}
+
+	prepareAllocator(allocator, 0);
+	if (flags & binary::kDeltaLayoutChanged) {
+		// Rebuild the table with the source's layout. Records keep their object if it has the right type, nested
+		// objects are registered again as the records holding them are decoded.
+		Pointers table(tableSize);
+		uint64_t recordCount = body.read<uint64_t>();
+		for (uint64_t ii = 0; ii < recordCount; ++ii) {
+			TableIndex index = body.read<uint64_t>();
+			const ReflectionData *type = types[body.read<uint32_t>()];
+			uint8_t recordFlags = body.read<uint8_t>();
+			assert(index < table.size());
+
+			ReflectedVariable variable(type, nullptr);
+			if (!(recordFlags & binary::kRecordNull)) {
+				bool reusable = (index < m_dataTable.size() && m_dataTable[index].needsSerialization &&
+								 m_dataTable[index].variable.reflectionData() == type && m_dataTable[index].variable.instanceData() != nullptr);
+				variable = reusable ? m_dataTable[index].variable : createInstance(type);
+			}
+			table[index] = TableRecord(variable, true);
+		}
+
+		// The root belongs to the caller so it can only be updated in place.
+		assert(!table.empty() && !m_dataTable.empty() && table[0].variable.instanceData() == m_dataTable[0].variable.instanceData());
+
+		m_dataTable.swap(table);
+		m_lookupTable.clear();
+	} else {
+		assert(tableSize == m_dataTable.size());
+	}
+
+	DeltaMemberCache members;
+	uint64_t changeCount = body.read<uint64_t>();
+	for (uint64_t ii = 0; ii < changeCount; ++ii) {
+		TableIndex index = body.read<uint64_t>();
+		uint32_t ordinal = body.read<uint32_t>();
+		uint32_t subobjectCount = body.read<uint32_t>();
+		uint64_t payloadSize = body.read<uint64_t>();
+		assert(index < m_dataTable.size());
+
+		BinaryRecordReader record;
+		record.subobjects = body.subReader(subobjectCount * sizeof(uint64_t));
+		record.payload = body.subReader(payloadSize);
+
+		ReflectedVariable variable = m_dataTable[index].variable;
+		const DeltaMembers &typeMembers = deltaMembers(variable.reflectionData(), members);
+		assert(ordinal < typeMembers.size());
+		ReflectionData::deserializeMemberBinary(&variable, typeMembers[ordinal], record, *this);
+	}
+
+	patchPointers();
+	m_pointersToPatch.clear();
+}
+
+void PointerTable::patchPointers()
+{
+    for (auto &pointer : m_pointersToPatch) {
+        ReflectedVariable *tablePointer = &(m_dataTable[pointer.index].variable);
+
+        // Set the pointer to the proper pointer in the table.
+        pointer.variable.value<void *>() = (void *)tablePointer->instanceData();
     }
-	return false;
+}
+
+void PointerTable::addPatchPointer(PointerTable::TableIndex index, ReflectedVariable &pointer)
+{
+    PatchPointer pointerToPatch;
+    pointerToPatch.index = index;
+    pointerToPatch.variable = pointer;
+	m_pointersToPatch.push_back(pointerToPatch);
+}
+
+PointerTable::TableIndex PointerTable::addPointer(const ReflectedVariable &pointer, bool needsSerialization, bool &added)
+{
+	PointerAddress address = reinterpret_cast<PointerAddress>(pointer.instanceData());
+	TableIndex index = m_lookupTable.insert(address, pointer.reflectionData(), m_dataTable.size(), added);
+
+	if (added) {
+		m_dataTable.push_back(TableRecord(pointer, needsSerialization));
+	} else if (!needsSerialization) {
+		// This pointer already exists in the table but has now been found within another object. The
+		// other object will serialize it so it no longer needs to be serialized by itself.
+		m_dataTable[index].needsSerialization = false;
+	}
+
+	return index;
 }
 
 } // namespace carl.
\ No newline at end of file
@@ -15,12 +15,33 @@
 ///
 
 #include "ReflectedVariable.h"
+#include "SerializationFormat.h"
+#include "AddressTable.h"
+#include "BinaryStream.h"
+#include "StreamSchema.h"
 
+#include <cstdint>
+#include <mutex>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 
 namespace carl {
 
+// Forward declarations.
+class Allocator;
+class ThreadPool;
+class DeltaBaseline;
+
+///
+/// Options for PointerTable::deserializeInPlace().
+///
+struct InPlaceOptions
+{
+    bool       referenceRecords = true;  ///< If true, suitably aligned records of block copyable types are used directly from the source memory instead of being copied.
+    Allocator *allocator = nullptr;      ///< Allocator to create objects with, nullptr to allocate each object on the heap.
+    ThreadPool *pool = nullptr;          ///< If not nullptr, records are decoded in parallel on this pool.
+};
+
 class PointerTable
 {
 public:
@@ -51,6 +72,20 @@ public:
     ///
     void populate(const ReflectedVariable &reflectedVariable, bool needsSerialization);
 
+    ///
+    /// Reserve space for a number of objects ahead of populating the table to avoid repeated growth.
+    ///
+    /// @param objectCount Number of objects the table is expected to hold.
+    ///
+    void reserve(size_t objectCount);
+
+    ///
+    /// Get the number of objects stored in the table.
+    ///
+    /// @return Number of objects in the table.
+    ///
+    inline size_t size() const { return m_dataTable.size(); }
+
     ///
     /// Get access to a specific pointer in the table by index.
     ///
@@ -59,6 +94,15 @@ public:
     ///
     const ReflectedVariable &pointer(TableIndex index);
 
+    ///
+    /// Set the variable stored at a specific index in the table. Used while deserializing
+    /// to register objects (and nested objects) as they are created.
+    ///
+    /// @param index Location of the pointer in the table.
+    /// @param variable Variable to store at this location.
+    ///
+    void setPointer(TableIndex index, const ReflectedVariable &variable);
+
     ///
     /// Get the index in the table for a particular pointer.
     ///
@@ -67,12 +111,26 @@ public:
     ///
     TableIndex index(const ReflectedVariable &variable) const;
 
+    ///
+    /// Get the index in the table for a particular pointer, checking the entry at 'hint' before searching the
+    /// lookup table. Nested objects without pointers of their own follow each other in the table, so walking
+    /// them with the previous index + 1 as the hint avoids most searches.
+    ///
+    /// @param variable Variable in the table to get the index for.
+    /// @param hint Likely index of the variable.
+    /// @return The index of the variable in the table.
+    ///
+    TableIndex index(const ReflectedVariable &variable, TableIndex hint) const;
+
     ///
     /// Serialize this pointer table to an output stream.
     ///
     /// @param stream The output stream to serialize the pointer table to.
+    /// @param format Format to write the table in.
+    /// @param pool If not nullptr, records are encoded in parallel on this pool. The output is identical to
+    ///             the output without a pool.
     ///
-    void serialize(std::ostream &stream);
+    void serialize(std::ostream &stream, SerializationFormat format = SerializationFormat::Text, ThreadPool *pool = nullptr);
 
     ///
     /// Deserialize the table from an input stream. The deserialization process works by first allocating a pointer
@@ -80,9 +138,97 @@ public:
     /// is read from the stream. While reading, if a pointer is encountered, it's index is saved for later patching after
     /// the entire table has been read in.
     ///
+    /// The characters of std::string_view members are kept by the allocator (see Allocator::keepCharacters()).
+    /// Columnar data can't be read once the layout of its types has changed, the stream's fail bit is then set
+    /// and the table is left empty.
+    ///
     /// @param stream The input stream containing a serialized table for reading.
+    /// @param format Format that the table was written in.
+    /// @param allocator Allocator to create the deserialized objects with, nullptr to allocate each object on the heap.
+    /// @param pool If not nullptr, binary records are decoded and patched in parallel on this pool. Objects are still
+    ///             created sequentially so the allocator does not need to be thread safe. Binary data written by
+    ///             serializeStreaming() and columnar data are always decoded sequentially.
+    ///
+    void deserialize(std::istream &stream, SerializationFormat format = SerializationFormat::Text, Allocator *allocator = nullptr, ThreadPool *pool = nullptr);
+
+    ///
+    /// Serialize the graph under a variable in the binary format without populating the table up front. Records
+    /// are encoded as the graph is walked and handed to 'sink' in chunks of a fixed size, so neither the encoded
+    /// records nor the whole table are ever held in memory (see ReflectedVariable::serializeStreaming()). The
+    /// table must be empty and is left empty.
+    ///
+    /// @param root Root of the graph to serialize.
+    /// @param sink Function receiving the serialized data.
+    /// @param chunkSize Size of each chunk passed to 'sink' (in bytes), only the last chunk can be smaller.
+    ///
+    void serializeStreaming(const ReflectedVariable &root, const StreamSink &sink, size_t chunkSize = kDefaultStreamChunkSize);
+
+    ///
+    /// Deserialize a table written in the binary format directly from memory. Unlike deserialize(), the
+    /// memory is required to outlive the deserialized objects: std::string_view members point into it, as do
+    /// records which are referenced in place. Records referenced in place are not allocated and must not be
+    /// destroyed individually. The memory must be writable if those objects are going to be modified.
+    ///
+    /// @param data Start of the serialized table.
+    /// @param size Size of the serialized table (in bytes).
+    /// @param options Options controlling how records are loaded.
+    ///
+    void deserializeInPlace(char *data, size_t size, const InPlaceOptions &options = InPlaceOptions());
+
+    ///
+    /// Copy every object in this table into another table without going through a stream (see
+    /// ReflectedVariable::deepClone()). The copies take the same indices as their sources so shared and cyclic
+    /// references are preserved. Ownership of the copied objects passes to the caller, as with deserialize().
+    ///
+    /// @param target Empty table to copy into.
+    /// @param allocator Allocator to create the copies with, nullptr to allocate each object on the heap.
+    ///
+    void clone(PointerTable &target, Allocator *allocator = nullptr);
+
     ///
-    void deserialize(std::istream &stream);
+    /// Compute a structural hash of the objects in this table (see ReflectedVariable::hash()).
+    ///
+    /// @return 64-bit hash.
+    ///
+    uint64_t hash();
+
+    ///
+    /// Encode the current state of every record in this table into a delta baseline (see DeltaBaseline.h).
+    ///
+    /// @param baseline Baseline to capture into. Any previous state is replaced.
+    ///
+    void captureBaseline(DeltaBaseline &baseline);
+
+    ///
+    /// Write the members of this table's records which changed since 'baseline' was captured, then update
+    /// the baseline to the current state.
+    ///
+    /// @param stream Output stream to write the delta to.
+    /// @param baseline Previous state of the table.
+    ///
+    void serializeDelta(std::ostream &stream, DeltaBaseline &baseline);
+
+    ///
+    /// Apply a delta to the objects of this table. The table must have been populated from a graph which
+    /// matches the baseline the delta was written against.
+    ///
+    /// @param stream Input stream to read the delta from.
+    /// @param allocator Allocator to create objects added by the delta with, nullptr for the heap. Also keeps the
+    ///                  characters of changed std::string_view members.
+    ///
+    void applyDelta(std::istream &stream, Allocator *allocator = nullptr);
+
+    ///
+    /// Destroy every object that was allocated while deserializing this table. Ownership of deserialized objects
+    /// otherwise passes to the caller. Objects are destroyed through the allocator that created them, which does
+    /// nothing for an Arena (the arena releases them instead).
+    ///
+    void destroyAllocatedObjects();
+
+    ///
+    /// Destroy every allocated object (see destroyAllocatedObjects()) and empty the table so that it can be reused.
+    ///
+    void clear();
 
     ///
     /// Add a pointer to the patch table. Any pointers added here will have their instance data set to
@@ -93,24 +239,244 @@ public:
     ///
     void addPatchPointer(PointerTable::TableIndex index, ReflectedVariable &pointer);
 
+    ///
+    /// Have the allocator keep the characters of a std::string_view read from memory which does not outlive the
+    /// deserialized objects. Safe to call while records are decoded in parallel.
+    ///
+    /// @param characters Characters to keep.
+    /// @return View of the kept characters.
+    ///
+    std::string_view keepCharacters(std::string_view characters);
+
 private:
 
+    // Decodes records one at a time through the binary helpers below.
+    friend class PartialLoader;
+
+    ///
+    /// An object waiting to be added to the table by populate().
+    ///
+    struct PendingObject
+    {
+        ReflectedVariable variable;           ///< Object to add.
+        bool              needsSerialization; ///< If true, the object needs to be serialized by the table.
+    };
+
+    ///
+    /// Gather the objects referenced by the members of an object (and those of its parent types).
+    ///
+    /// @param reflectedVariable Object whose members should be gathered.
+    /// @param reflectionData Type to gather the members of. Parent types are processed first.
+    /// @param children Objects to add to the table, in member order.
+    ///
+    void populateMembers(const ReflectedVariable &reflectedVariable, const ReflectionData *reflectionData, std::vector<PendingObject> &children);
+
+    ///
+    /// Gather the objects referenced by the elements of a container.
+    ///
+    /// @param container Container whose elements should be gathered.
+    /// @param containerData Type of the container.
+    /// @param children Objects to add to the table, in element order.
+    ///
+    void populateContainer(void *container, const ReflectionData *containerData, std::vector<PendingObject> &children);
+
+    ///
+    /// Format specific implementations of serialize() and deserialize().
+    ///
+    void serializeText(std::ostream &stream, ThreadPool *pool);
+    void serializeBinary(std::ostream &stream, ThreadPool *pool);
+
+    ///
+    /// Maximum number of records encoded in parallel before they are written to the stream. Bounds the memory
+    /// used for staging encoded records.
+    ///
+    static constexpr size_t kRecordsPerWave = 64 * 1024;
+
+    ///
+    /// Write a single table entry in the text format (if it needs to be serialized by the table).
+    ///
+    /// @param stream Stream to write to.
+    /// @param index Entry to write.
+    ///
+    void serializeTextRecord(std::ostream &stream, TableIndex index);
+
+    ///
+    /// Encode the payload and sub-objects of a single binary record.
+    ///
+    /// @param index Entry to encode.
+    /// @param record Staging area to encode into.
+    /// @return Flags of the record.
+    ///
+    uint8_t serializeBinaryRecord(TableIndex index, BinaryRecordWriter &record);
+
+    ///
+    /// Write an encoded binary record (header, sub-objects, padding and payload) to a stream.
+    ///
+    /// @param stream Stream to write to.
+    /// @param scratch Buffer used to stage the record header.
+    /// @param index Table index of the record.
+    /// @param typeId Stream type id of the record.
+    /// @param flags Flags of the record.
+    /// @param record Encoded record.
+    /// @param offset Number of bytes written to the stream so far, updated to include this record.
+    ///
+    void writeBinaryRecord(std::ostream &stream, BinaryWriter &scratch, TableIndex index, uint32_t typeId, uint8_t flags,
+                           const BinaryRecordWriter &record, uint64_t &offset) const;
+
+    ///
+    /// Append everything of an encoded binary record but its payload (size, header, sub-objects and padding).
+    ///
+    /// @param writer Writer to append to.
+    /// @param reflectionData Type of the record, the payload is padded out to its alignment.
+    /// @param index Table index of the record.
+    /// @param typeId Stream type id of the record.
+    /// @param flags Flags of the record.
+    /// @param record Encoded record.
+    /// @param offset Number of bytes written to the stream before the record, updated to include this record.
+    ///
+    static void writeBinaryRecordHeader(BinaryWriter &writer, const ReflectionData *reflectionData, TableIndex index, uint32_t typeId,
+                                        uint8_t flags, const BinaryRecordWriter &record, uint64_t &offset);
+    void deserializeText(std::istream &stream, Allocator *allocator);
+    void deserializeBinary(std::istream &stream, Allocator *allocator, ThreadPool *pool);
+
+    ///
+    /// Write the table in the columnar format (see BinaryStream.h). Records are grouped by type and each group is
+    /// written column by column.
+    ///
+    /// @param stream Stream to write to.
+    ///
+    void serializeColumnar(std::ostream &stream);
+
+    ///
+    /// Read a table written by serializeColumnar(). Groups whose type is no longer registered are skipped. If the
+    /// layout of any other type changed since the data was written, the stream's fail bit is set and the table is
+    /// cleared (the same data can be remapped when it's written in the binary format).
+    ///
+    /// @param stream Stream to read from.
+    /// @param allocator Allocator to create the deserialized objects with, nullptr for the heap.
+    ///
+    void deserializeColumnar(std::istream &stream, Allocator *allocator);
+
+    ///
+    /// Decode binary data written by serializeStreaming(), growing the table as records arrive.
+    ///
+    /// @param stream Stream positioned right after the magic.
+    /// @param allocator Allocator to create the deserialized objects with, nullptr for the heap.
+    ///
+    void deserializeStreamed(std::istream &stream, Allocator *allocator);
+
+    ///
+    /// Set all pointers added via addPatchPointer() to their final location in the table.
+    ///
+    void patchPointers();
+
+    ///
+    /// Information read from the header of a binary stream.
+    ///
+    struct BinaryHeader
+    {
+        uint64_t     recordCount = 0; ///< Number of records which follow the header.
+        uint32_t     typeCount = 0;   ///< Number of types in the schema.
+        uint64_t     schemaSize = 0;  ///< Size of the schema which follows the fixed portion of the header (in bytes).
+        StreamSchema schema;          ///< Layout of the stream's types, matched against the registered types.
+    };
+
+    ///
+    /// Size of the fixed portion of a binary header (everything before the schema).
+    ///
+    static constexpr size_t kBinaryFixedHeaderSize = 4 + 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t);
+
+    ///
+    /// Read the fixed portion of a binary header and size the table accordingly. The schema is read by the caller.
+    ///
+    /// @param reader Reader positioned at the start of the header.
+    /// @param header Header to populate.
+    ///
+    void readBinaryHeader(BinaryReader &reader, BinaryHeader &header);
+
+    ///
+    /// Decode a single binary record (everything after the record size) into the table.
+    ///
+    /// @param reader Reader covering exactly the record.
+    /// @param header Header of the stream the record belongs to.
+    /// @param persistent If true, the record's memory outlives the deserialized objects.
+    /// @param referenceInPlace If true, block copyable records are used directly from the record's memory.
+    /// @return Table index of the record.
+    ///
+    TableIndex deserializeBinaryRecord(BinaryReader &reader, const BinaryHeader &header, bool persistent, bool referenceInPlace);
+
+    ///
+    /// Decode every record of a binary stream in parallel. An index of the records is built first, then all objects
+    /// are created, then the records are decoded concurrently and finally their pointers are patched concurrently.
+    ///
+    /// @param reader Reader positioned at the first record.
+    /// @param header Header of the stream the records belong to.
+    /// @param persistent If true, the records' memory outlives the deserialized objects.
+    /// @param referenceInPlace If true, block copyable records are used directly from the record's memory.
+    /// @param pool Pool to decode the records on.
+    ///
+    void deserializeBinaryRecords(BinaryReader &reader, const BinaryHeader &header, bool persistent, bool referenceInPlace, ThreadPool &pool);
+
+    ///
+    /// A binary record whose header has been read.
+    ///
+    struct BinaryRecordInfo
+    {
+        const ReflectionData *reflectionData = nullptr; ///< Type of the record, nullptr if the type is no longer registered.
+        uint32_t              typeId = 0;               ///< Stream type id of the record.
+        bool                  remapped = false;         ///< If true, the record's layout differs from its type and it's decoded through the schema.
+        TableIndex            index = 0;                ///< Table index of the record.
+        uint8_t               flags = 0;                ///< Flags of the record.
+        BinaryRecordReader    record;                   ///< Sub-objects and payload of the record.
+        size_t                dataSize = 0;             ///< Size of the sub-object list and payload (in bytes).
+    };
+
+    ///
+    /// Read the header of a single binary record (everything after the record size).
+    ///
+    /// @param reader Reader covering exactly the record.
+    /// @param header Header of the stream the record belongs to.
+    /// @param persistent If true, the record's memory outlives the deserialized objects.
+    /// @param info Record to populate.
+    ///
+    void readBinaryRecordHeader(BinaryReader &reader, const BinaryHeader &header, bool persistent, BinaryRecordInfo &info);
+
+    ///
+    /// Create the object for a record (or reference it in place) and register it in the table.
+    ///
+    /// @param info Record to place.
+    /// @param referenceInPlace If true, block copyable records are used directly from the record's memory.
+    /// @param variable Set to the created object.
+    /// @return True if the record's payload still needs to be decoded into 'variable'.
+    ///
+    bool placeBinaryRecord(BinaryRecordInfo &info, bool referenceInPlace, ReflectedVariable &variable);
+
+    ///
+    /// Create an instance of a type with the current allocator and record it as allocated by this table.
+    ///
+    /// @param reflectionData Type to create.
+    /// @return Variable holding the new instance.
+    ///
+    ReflectedVariable createInstance(const ReflectionData *reflectionData);
+
+    ///
+    /// Set the allocator used to create objects while deserializing and let it know how many objects to expect.
+    ///
+    /// @param allocator Allocator to use, nullptr for the heap.
+    /// @param byteCount Estimate of the total size of the objects (in bytes), 0 if unknown.
+    ///
+    void prepareAllocator(Allocator *allocator, size_t byteCount);
+
     ///
     /// Add a pointer to the table. If this pointer already exists in the table,
     /// the existing index is returned.
     ///
     /// @param pointer Pointer to store in the table as reflection data.
     /// @param needsSerialization If true, this variable will be serialized with the pointer table.
+    /// @param added Set to true if the pointer was not in the table before this call.
     /// @return Index in the table for this pointer.
     ///
-    TableIndex addPointer(const ReflectedVariable &pointer, bool needsSerialization);
-
-    ///
-    /// Determine if a specific instance is located in the pointer table.
-    ///
-    /// @return If true, the table already includes this variable.
-    ///
-    bool hasPointer(const ReflectedVariable &variable) const;
+    TableIndex addPointer(const ReflectedVariable &pointer, bool needsSerialization, bool &added);
 
     ///
     /// Underlying pointer data stored in a linear table.
@@ -126,22 +492,13 @@ private:
 
     ///
     /// Lookup table to map pointer addresses to indices in the 'Pointers' table.
-    /// First argument is the pointer address, second is the table index per type that sits
-    /// at that address. Assume an object looks like this:
+    /// Entries are keyed on both the address and the type of the object. Assume an object looks like this:
     /// class Foo { int x; };
     /// Foo f;
     /// In this case, &f == &x because of how memory is laid out by the compiler. Therefore, two different
-    /// objects can report the same address, hence the list of pairs in the lookup table.
-    ///
-    struct Instance {
-        Instance() = default;
-        Instance(const ReflectionData *data, TableIndex index) :
-            reflectionData(data), tableIndex(index) {}
-        const ReflectionData *reflectionData = nullptr;
-        TableIndex tableIndex = 0;
-    };
-    using Objects = std::list<Instance>;
-    using LookupTable = std::unordered_map<PointerAddress, Objects>;
+    /// objects can report the same address. Reflection data is a singleton per type so it doubles as the type key.
+    ///
+    using LookupTable = AddressTable;
 
     Pointers m_dataTable;      ///< Pointer data stored linearly by index.
     LookupTable m_lookupTable; ///< Lookup table storing correlations between pointer addresses and table indices.
@@ -153,6 +510,11 @@ private:
 
     using PointerPatchTable = std::vector<PatchPointer>;
     PointerPatchTable m_pointersToPatch; ///< Pointers to patch-up after deserializing the entire table.
+
+    std::vector<ReflectedVariable> m_allocatedObjects; ///< Objects allocated while deserializing.
+    Allocator *m_allocator = nullptr;                  ///< Allocator used to create (and destroy) m_allocatedObjects.
+
+    std::mutex m_charactersMutex; ///< Guards the allocator while characters are kept from parallel decoding.
 };
 
 } // namespace carl
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "ReflectedVariable.h"
 #include "ReflectionData.h"
 #include "PointerTable.h"
+#include "GraphComparer.h"
 #include <sstream>
 
 namespace carl {
@@ -63,7 +64,7 @@ void ReflectedVariable::setInstanceData(const void *data)
 	m_instanceData = const_cast<void *>(data);
 }
 
-void ReflectedVariable::serialize(std::ostream &stream) const
+void ReflectedVariable::serialize(std::ostream &stream, SerializationFormat format, ThreadPool *pool) const
 {
 	// Add all objects that are referenceable from this variable
 	// to the pointer table. This table will then be used to patch
@@ -72,20 +73,82 @@ void ReflectedVariable::serialize(std::ostream &stream) const
 	table.populate(*this, true);
 
 	// At this point, we'll have a valid pointer table that needs to be serialized.
-	table.serialize(stream);
+	table.serialize(stream, format, pool);
 }
 
-void ReflectedVariable::deserialize(std::istream &stream)
+void ReflectedVariable::serializeStreaming(const StreamSink &sink, size_t chunkSize) const
+{
+	// The table is filled in as the graph is walked instead of up front.
+	PointerTable table;
+	table.serializeStreaming(*this, sink, chunkSize);
+}
+
+void ReflectedVariable::deserialize(std::istream &stream, SerializationFormat format, Allocator *allocator, ThreadPool *pool)
 {
 	// Create the pointer table to use for pointer patching while deserializing.
 	PointerTable table;
 
 	// Deserialize the stream into the table.
-	table.deserialize(stream);
+	table.deserialize(stream, format, allocator, pool);
 
 	// Extract the first element of the table since element 0 represents 
-	// the main (parent) variable being extracted.
-	this->value<void *>() = table.pointer(0).m_instanceData;
+	// the main (parent) variable being extracted. A table which can't be read is left empty.
+	this->value<void *>() = (table.size() > 0) ? table.pointer(0).m_instanceData : nullptr;
+}
+
+ReflectedVariable ReflectedVariable::deepClone(Allocator *allocator) const
+{
+	PointerTable table;
+	table.populate(*this, true);
+
+	PointerTable copies;
+	table.clone(copies, allocator);
+
+	// Element 0 is the copy of this variable.
+	return copies.pointer(0);
+}
+
+bool ReflectedVariable::equals(const ReflectedVariable &other) const
+{
+	GraphComparer comparer;
+	return comparer.compare(*this, other);
+}
+
+bool ReflectedVariable::diff(const ReflectedVariable &other, std::vector<std::string> &paths, bool findAll) const
+{
+	GraphComparer comparer(findAll);
+	bool equal = comparer.compare(*this, other);
+	paths.insert(paths.end(), comparer.differences().begin(), comparer.differences().end());
+	return !equal;
+}
+
+uint64_t ReflectedVariable::hash() const
+{
+	PointerTable table;
+	table.populate(*this, true);
+	return table.hash();
+}
+
+void ReflectedVariable::captureBaseline(DeltaBaseline &baseline) const
+{
+	PointerTable table;
+	table.populate(*this, true);
+	table.captureBaseline(baseline);
+}
+
+void ReflectedVariable::serializeDelta(std::ostream &stream, DeltaBaseline &baseline) const
+{
+	PointerTable table;
+	table.populate(*this, true);
+	table.serializeDelta(stream, baseline);
+}
+
+void ReflectedVariable::applyDelta(std::istream &stream, Allocator *allocator)
+{
+	// Index the target graph exactly like the source graph was indexed when the delta was written.
+	PointerTable table;
+	table.populate(*this, true);
+	table.applyDelta(stream, allocator);
 }
 
 } // namespace carl
\ No newline at end of file
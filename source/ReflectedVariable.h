@@ -13,12 +13,20 @@
 /// a specific instance of the type.
 ///
 
+#include "SerializationFormat.h"
+
+#include <cstdint>
 #include <ostream>
+#include <string>
+#include <vector>
 
 namespace carl {
 
 // Forward declarations.
 class ReflectionData;
+class Allocator;
+class ThreadPool;
+class DeltaBaseline;
 
 class ReflectedVariable
 {
@@ -77,15 +85,106 @@ class ReflectedVariable
         /// Serialize this variable to the specified stream.
         ///
         /// @param stream Output stream to write the serialized data to.
+        /// @param format Format to write the data in.
+        /// @param pool If not nullptr, the objects are encoded in parallel on this pool.
         ///
-        void serialize(std::ostream &stream) const;
+        void serialize(std::ostream &stream, SerializationFormat format = SerializationFormat::Text, ThreadPool *pool = nullptr) const;
 
 		///
 		/// Deserialize this variable to the specified stream.
 		///
 		/// @param stream Input stream to read the serialized data from.
+		/// @param format Format that the data was written in.
+		/// @param allocator Allocator to create the deserialized objects with, nullptr to allocate each object
+		///                  on the heap. When using an Arena, the objects are released by releasing the arena.
+		/// @param pool If not nullptr, binary data is decoded in parallel on this pool.
+		///
+		/// The characters of std::string_view members are kept by the allocator: an Arena releases them with the
+		/// objects, otherwise they are interned for the life of the process (see Allocator::keepCharacters()).
+		/// If the data can't be read (columnar data whose types changed), the stream's fail bit is set and this
+		/// variable is set to nullptr.
+		///
+		void deserialize(std::istream &stream, SerializationFormat format = SerializationFormat::Text, Allocator *allocator = nullptr, ThreadPool *pool = nullptr);
+
+		///
+		/// Serialize this variable in the binary format while walking the graph under it. Each object is encoded as
+		/// soon as it is reached and the output is handed to 'sink' in chunks of a fixed size, so the encoded data is
+		/// never held in memory. What is held is the current chunk, the encoding of the largest object, one index
+		/// entry per object and the objects which have been found through pointers but not written yet (all of the
+		/// pointers of an object are followed once it's written, depth-first). The output is read back with
+		/// deserialize() and the binary format.
+		///
+		/// @param sink Function receiving the serialized data.
+		/// @param chunkSize Size of each chunk passed to 'sink' (in bytes), only the last chunk can be smaller.
+		///
+		void serializeStreaming(const StreamSink &sink, size_t chunkSize = kDefaultStreamChunkSize) const;
+
+		///
+		/// Create a deep copy of the graph under this variable without a stream round trip. Members are copied
+		/// directly (plain bytes as a single block) and pointers are remapped to the copies, so shared and cyclic
+		/// references are preserved exactly as serialize() followed by deserialize() would preserve them.
+		///
+		/// @param allocator Allocator to create the copies with, nullptr to allocate each object on the heap.
+		///                  When using an Arena, the copies are released by releasing the arena.
+		/// @return Variable holding the copy of this variable. Ownership of every copied object passes to the caller.
+		///
+		ReflectedVariable deepClone(Allocator *allocator = nullptr) const;
+
+		///
+		/// Determine if the graph under this variable is structurally equal to the graph under another variable of
+		/// the same type (see GraphComparer.h). Objects are compared member by member and pointers are followed, so
+		/// graphs with the same contents and shape are equal regardless of where they live in memory.
+		///
+		/// @param other Root of the graph to compare against.
+		/// @return If true, the graphs are equal.
+		///
+		bool equals(const ReflectedVariable &other) const;
+
+		///
+		/// Compare the graph under this variable with the graph under another variable of the same type and collect
+		/// the paths of the members which differ (e.g. "next.items[3].x").
+		///
+		/// @param other Root of the graph to compare against.
+		/// @param paths Differing member paths are appended here.
+		/// @param findAll If false, the comparison stops at the first difference.
+		/// @return If true, the graphs differ.
+		///
+		bool diff(const ReflectedVariable &other, std::vector<std::string> &paths, bool findAll = false) const;
+
+		///
+		/// Compute a structural hash of the graph under this variable without serializing it. Objects are visited in the
+		/// same order as they are serialized and pointers (including cycles) are hashed as their pointer table index, so
+		/// graphs with the same contents and shape hash the same regardless of where they live in memory.
+		///
+		/// @return 64-bit hash of the graph.
+		///
+		uint64_t hash() const;
+
+		///
+		/// Record the current state of the graph under this variable as a baseline for serializeDelta().
+		///
+		/// @param baseline Baseline to capture into. Any previous state is replaced.
+		///
+		void captureBaseline(DeltaBaseline &baseline) const;
+
+		///
+		/// Write the members of the graph under this variable which changed since 'baseline' was captured
+		/// (see DeltaBaseline.h). The baseline is then updated to the current state of the graph.
+		///
+		/// @param stream Output stream to write the delta to.
+		/// @param baseline Previous state of the graph, an empty baseline writes every member.
+		///
+		void serializeDelta(std::ostream &stream, DeltaBaseline &baseline) const;
+
+		///
+		/// Apply a delta written by serializeDelta() in place to the graph under this variable. The graph must
+		/// match the baseline the delta was written against.
+		///
+		/// @param stream Input stream to read the delta from.
+		/// @param allocator Allocator to create objects added by the delta with, nullptr to allocate each object
+		///                  on the heap.
 		///
-		void deserialize(std::istream &stream);
+		void applyDelta(std::istream &stream, Allocator *allocator = nullptr);
     
     private:
     
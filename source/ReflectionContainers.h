@@ -0,0 +1,229 @@
+//
+//  ReflectionContainers.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Reflection support for members which are standard containers: std::vector, std::array and std::map.
+/// Container types are registered lazily the first time a member of that type is reflected and are
+/// never added to the ReflectionDataManager as they can't be records on their own.
+///
+/// Elements may be primitives, reflected classes, pointers to reflected classes or other containers.
+/// Elements which are reflected classes get their own entry in the pointer table (just like elements
+/// of C arrays) so pointers to them survive a round trip. Map keys must not be reflected classes or
+/// pointers.
+///
+/// In the binary format, vectors and arrays of block copyable elements (see ReflectionData::isBlockCopyable())
+/// are written as a single block. Vectors are resized once before their elements are read.
+///
+
+#include "ReflectionData.h"
+#include "QualifierRemover.h"
+
+#include <array>
+#include <assert.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace carl {
+
+///
+/// Type erased description of a container type.
+///
+struct ContainerInfo
+{
+    enum class Kind : uint8_t
+    {
+        Vector, ///< std::vector, elements are contiguous and the size is dynamic.
+        Array,  ///< std::array, elements are contiguous and the size is fixed.
+        Map     ///< std::map, key and value pairs.
+    };
+
+    ///
+    /// Function called per element. 'key' is only set for maps, 'element' is the map value otherwise.
+    ///
+    using Visitor = std::function<void(const void *key, void *element)>;
+
+    ///
+    /// Function which fills in a default constructed map key.
+    ///
+    using KeyReader = std::function<void(void *key)>;
+
+    Kind                  kind = Kind::Vector;
+    const ReflectionData *element = nullptr;        ///< Type of the elements (map values). The pointed to type for pointer elements.
+    const ReflectionData *key = nullptr;            ///< Type of the map keys (maps only).
+    bool                  elementIsPointer = false; ///< If true, each element is a pointer to an instance of 'element'.
+    size_t                elementSize = 0;          ///< Size of a single element within the container (in bytes).
+
+    size_t (*size)(const void *container) = nullptr;                           ///< Number of elements in the container.
+    void   (*clear)(void *container) = nullptr;                                ///< Remove all elements (vectors and maps only).
+    void  *(*data)(const void *container) = nullptr;                           ///< Contiguous element storage (vectors and arrays only).
+    void   (*resize)(void *container, size_t count) = nullptr;                 ///< Resize to 'count' elements, new elements are default constructed (vectors and arrays only, arrays must keep their size).
+    void   (*forEach)(const void *container, const Visitor &visitor) = nullptr;  ///< Visit each element in order (maps only).
+    void  *(*insert)(void *container, const KeyReader &readKey) = nullptr;     ///< Insert a key filled in by 'readKey' and return its value (maps only).
+
+    ///
+    /// Determine if the elements are stored contiguously.
+    ///
+    /// @return If true, data() and resize() are available.
+    ///
+    inline bool isContiguous() const { return (data != nullptr); }
+
+    ///
+    /// Call 'function(key, element)' for each element of a container in order. 'key' is only set for maps.
+    ///
+    /// @param container Container to iterate over.
+    /// @param function Function to call per element.
+    ///
+    template<class Function>
+    inline void forEachElement(const void *container, Function &&function) const
+    {
+        if (isContiguous()) {
+            char *elements = static_cast<char *>(data(container));
+            size_t count = size(container);
+            for (size_t ii = 0; ii < count; ++ii) {
+                function(static_cast<const void *>(nullptr), static_cast<void *>(elements + ii * elementSize));
+            }
+        } else {
+            forEach(container, function);
+        }
+    }
+};
+
+///
+/// Detect which types are containers.
+///
+template<class T>
+struct ContainerTraits
+{
+    static const bool IsContainer = false;
+};
+
+template<class T, class Allocator>
+struct ContainerTraits<std::vector<T, Allocator>>
+{
+    static const bool IsContainer = true;
+    static const ContainerInfo::Kind kind = ContainerInfo::Kind::Vector;
+    typedef T Element;
+};
+
+template<class T, size_t N>
+struct ContainerTraits<std::array<T, N>>
+{
+    static const bool IsContainer = true;
+    static const ContainerInfo::Kind kind = ContainerInfo::Kind::Array;
+    typedef T Element;
+};
+
+template<class Key, class T, class Compare, class Allocator>
+struct ContainerTraits<std::map<Key, T, Compare, Allocator>>
+{
+    static const bool IsContainer = true;
+    static const ContainerInfo::Kind kind = ContainerInfo::Kind::Map;
+    typedef T Element;
+};
+
+template<class T>
+const ReflectionData *registerContainer();
+
+///
+/// Get the reflection data of a member's (qualifier free) type. Containers are registered on first use.
+///
+/// @return Reflection data of the type.
+///
+template<class T>
+inline const ReflectionData *memberReflectionData()
+{
+    if constexpr (ContainerTraits<T>::IsContainer) {
+        static const ReflectionData *data = registerContainer<T>();
+        return data;
+    } else {
+        return &ReflectionDataCreator<T>::instance();
+    }
+}
+
+///
+/// Determine if a type is a class declared with CARL_DECLARE_REFLECTED_CLASS(), which is stored as a set of data members.
+///
+template<class T, class = void>
+struct IsReflectedClass : std::false_type {};
+
+template<class T>
+struct IsReflectedClass<T, std::void_t<decltype(&T::registerReflectionData)>> : std::true_type {};
+
+///
+/// Register container type 'T'. Only called once per type via memberReflectionData().
+///
+/// @return Reflection data of the container type.
+///
+template<class T>
+const ReflectionData *registerContainer()
+{
+    typedef ContainerTraits<T> Traits;
+    typedef typename Traits::Element Element;
+    static_assert(!std::is_array<Element>::value, "Containers of C arrays can't be reflected, use std::array instead");
+    static_assert(Traits::kind != ContainerInfo::Kind::Vector || !std::is_same<Element, bool>::value,
+                  "std::vector<bool> can't be reflected as its elements are not addressable");
+
+    static ContainerInfo info;
+    info.kind = Traits::kind;
+    info.element = memberReflectionData<typename QualifierRemover<Element>::type>();
+    info.elementIsPointer = QualifierRemover<Element>::IsPointer;
+    info.elementSize = sizeof(Element);
+    info.size = [](const void *container) -> size_t { return static_cast<const T *>(container)->size(); };
+
+    const char *name = nullptr;
+    if constexpr (Traits::kind == ContainerInfo::Kind::Map) {
+        typedef typename T::key_type Key;
+        static_assert(!std::is_pointer<Key>::value, "Map keys can't be pointers");
+        static_assert(!IsReflectedClass<typename QualifierRemover<Key>::type>::value, "Map keys can't be reflected classes, only primitive types");
+
+        name = "std::map";
+        info.key = memberReflectionData<typename QualifierRemover<Key>::type>();
+        info.clear = [](void *container) { static_cast<T *>(container)->clear(); };
+        info.forEach = [](const void *container, const ContainerInfo::Visitor &visitor) {
+            for (auto &entry : *static_cast<T *>(const_cast<void *>(container))) {
+                visitor(&entry.first, &entry.second);
+            }
+        };
+        info.insert = [](void *container, const ContainerInfo::KeyReader &readKey) -> void * {
+            Key key{};
+            readKey(&key);
+            return &((*static_cast<T *>(container))[std::move(key)]);
+        };
+    } else {
+        info.data = [](const void *container) -> void * { return const_cast<Element *>(static_cast<const T *>(container)->data()); };
+        if constexpr (Traits::kind == ContainerInfo::Kind::Vector) {
+            name = "std::vector";
+            info.clear = [](void *container) { static_cast<T *>(container)->clear(); };
+            info.resize = [](void *container, size_t count) {
+                // Size the storage in one go before the elements are filled in. Existing elements are kept so
+                // that overwriting a container in place (see DeltaBaseline) doesn't move them.
+                static_cast<T *>(container)->resize(count);
+            };
+        } else {
+            name = "std::array";
+            info.resize = [](void *container, size_t count) {
+                assert(count == static_cast<T *>(container)->size());
+                (void)container;
+                (void)count;
+            };
+        }
+    }
+
+    ReflectionData &data = ReflectionDataCreator<T>::initUnregistered(name, sizeof(T));
+    data.setContainer(&info);
+    return &data;
+}
+
+} // namespace carl
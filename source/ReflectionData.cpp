@@ -7,12 +7,20 @@
 //
 
 #include "ReflectionData.h"
+#include "ReflectionContainers.h"
 #include "ReflectedVariable.h"
 #include "PointerTable.h"
 #include "ReflectionUtilities.h"
+#include "BinaryStream.h"
+#include "TextStream.h"
+#include "Hasher.h"
+#include "GraphComparer.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <cstring>
 #include <iostream>
+#include <sstream>
 
 namespace carl {
 
@@ -63,32 +71,66 @@ void ReflectionData::init(ReflectionDataCInfo &info)
 	assert(info.size > 0);
 	assert(info.name.length());
 	assert(info.allocateFunction != nullptr);
+	assert(info.destroyFunction != nullptr);
+	assert(info.constructFunction != nullptr);
+	assert(info.destructFunction != nullptr);
 
 	m_name = info.name;
 	m_size = info.size;
+	m_alignment = info.alignment;
+	m_isTriviallyCopyable = info.isTriviallyCopyable;
+	m_isTriviallyDestructible = info.isTriviallyDestructible;
 	m_allocateInstanceFunction = info.allocateFunction;
+	m_destroyInstanceFunction = info.destroyFunction;
+	m_constructInstanceFunction = info.constructFunction;
+	m_destructInstanceFunction = info.destructFunction;
+}
+
+void ReflectionData::addMember(const ReflectedMember *member)
+{
+	ReflectedMember *newMember = const_cast<ReflectedMember *>(member);
+	newMember->m_ordinal = m_members.size();
+	m_members.push_back(newMember);
+
+	assert(m_memberIndex.find(member->name()) == m_memberIndex.end());
+	m_memberIndex[member->name()] = member;
+}
+
+void ReflectionData::addMemberAlias(const std::string &name, const std::string &alias)
+{
+	auto iter = m_memberIndex.find(name);
+	assert(iter != m_memberIndex.end());
+	assert(m_memberIndex.find(alias) == m_memberIndex.end());
+	m_memberIndex[alias] = iter->second;
 }
 
 const ReflectedMember *ReflectionData::member(const std::string &name) const
 {
-    for (auto &member : m_members) {
-        if (member->name() == name) {
-            return member;
-        }
-    }
+	auto iter = m_memberIndex.find(name);
+	if (iter != m_memberIndex.end()) {
+		return iter->second;
+	}
 
 	return nullptr;
 }
     
 void padStream(std::ostream &stream, size_t pad)
 {
-    for (size_t ii = 0; ii < pad; ++ii) {
-        stream << "\t";
+    static const char kTabs[] = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+    for (; pad > sizeof(kTabs) - 1; pad -= sizeof(kTabs) - 1) {
+        stream.write(kTabs, sizeof(kTabs) - 1);
     }
+    stream.write(kTabs, pad);
 }
 
 void ReflectionData::serialize(const ReflectedVariable *variable, std::ostream &stream, PointerTable &pointerTable, size_t padding, bool isArray) const
 {
+	// Containers write their elements themselves.
+	if (m_container) {
+		serializeContainer(const_cast<void *>(variable->instanceData()), stream, pointerTable, padding);
+		return;
+	}
+
 	// If this object has a parent, serialize its data first.
 	if (m_parent) {
 		m_parent->serialize(variable, stream, pointerTable, padding);
@@ -104,26 +146,26 @@ void ReflectionData::serialize(const ReflectedVariable *variable, std::ostream &
 
 	// Write out the name of this type.
 	if (!isArray) {
-		stream << pointerTable.index(*variable) << " ";
+		text::writeValue(stream, pointerTable.index(*variable), ' ');
 	}
 
-	stream << m_name << std::endl;
+	stream << m_name << '\n';
 
 	// Make sure the instance data for this object is valid (could be a null pointer).
 	if (variable->instanceData() == nullptr) {
 		padStream(stream, padding);
-		stream << "[" << std::endl;
+		stream << "[\n";
 		++padding;
 		padStream(stream, padding);
-		stream << "null" << std::endl;
+		stream << "null\n";
 		--padding;
 		padStream(stream, padding);
-		stream << "]" << std::endl;
+		stream << "]\n";
 		return;
 	}
 
 	padStream(stream, padding);
-    stream << "[" << std::endl;
+    stream << "[\n";
     ++padding;
     for (auto &member : m_members) {
 		padStream(stream, padding);
@@ -136,12 +178,13 @@ void ReflectionData::serialize(const ReflectedVariable *variable, std::ostream &
 			void *pointerData = &(*(memberVariable.value<char *>()));
 			ReflectedVariable resolvedPointer(member->reflectionData(), pointerData);
 
-			stream << member->name() << " " << pointerTable.index(resolvedPointer) << std::endl;
+			stream << member->name() << ' ';
+			text::writeValue(stream, pointerTable.index(resolvedPointer), '\n');
 		}
 		// If this type is an array, we have to serialize each element of the array before moving on 
 		// to the next member variable.
 		else if (member->isArray()) {
-			stream << member->name() << std::endl;
+			stream << member->name() << '\n';
 			++padding;
 			const ReflectionData *data = member->reflectionData();
 			size_t baseTypeSize = data->size();
@@ -156,7 +199,7 @@ void ReflectionData::serialize(const ReflectedVariable *variable, std::ostream &
 			}
 			--padding;
 		} else { // non-array/pointer type.
-			stream << member->name() << " ";
+			stream << member->name() << ' ';
 			void *offsetData = pointerOffset(variable->instanceData(), member->offset());
 			ReflectedVariable memberVariable(member->reflectionData(), offsetData);
 			member->reflectionData()->serialize(&memberVariable, stream, pointerTable, padding, false);
@@ -165,14 +208,37 @@ void ReflectionData::serialize(const ReflectedVariable *variable, std::ostream &
 
     --padding;
     padStream(stream, padding);
-	stream << "]" << std::endl;
+	stream << "]\n";
 }
 
-void ReflectionData::deserialize(ReflectedVariable *variable, std::istream &stream, PointerTable &pointerTable, bool isArray) const
+void ReflectionData::deserialize(ReflectedVariable *variable, std::istream &stream, PointerTable &pointerTable, bool isArray, const size_t *recordIndex) const
 {
-	// If this object has a parent, deserialize its data first.
+	// Containers read their elements themselves.
+	if (m_container) {
+		deserializeContainer(const_cast<void *>(variable->instanceData()), stream, pointerTable);
+		return;
+	}
+
+	// If this object has a parent, deserialize its data first. The record header belongs to the
+	// base-most type as it is the first one written.
 	if (m_parent) {
-		m_parent->deserialize(variable, stream, pointerTable, isArray);
+		m_parent->deserialize(variable, stream, pointerTable, isArray, recordIndex);
+		recordIndex = nullptr;
+	}
+
+	// Views are written like strings but their characters have to be kept by the allocator.
+	if (this == &ReflectionDataCreator<std::string_view>::instance()) {
+		size_t length = 0;
+		text::readValue(stream, length);
+
+		// Skip the space inserted by the serialization function.
+		stream.get();
+
+		std::string &characters = text::scratchBuffer();
+		characters.resize(length);
+		stream.read(characters.data(), length);
+		variable->value<std::string_view>() = pointerTable.keepCharacters(characters);
+		return;
 	}
 
 	// If this type has a valid deserialization function then it knows how to deserialize itself, let it.
@@ -187,23 +253,31 @@ void ReflectionData::deserialize(ReflectedVariable *variable, std::istream &stre
 
 	// Read the pointer table index and typename first if we're not deserializing an array.
 	PointerTable::TableIndex tableIndex = 0;
-	if (!isArray) {
-		stream >> tableIndex;
-		assert(tableIndex >= 0);
-	}
+	if (recordIndex) {
+		tableIndex = *recordIndex;
+	} else {
+		if (!isArray) {
+			text::readValue(stream, tableIndex);
+			assert(tableIndex >= 0);
+		}
 
-	stream >> streamInput;
-	assert(streamInput == m_name);
+		text::readToken(stream, streamInput);
+		assert(streamInput == m_name);
+	}
 
 	// Read the starting bracket denoting the start of member variables for this type.
 	{
-		stream >> streamInput;
+		text::readToken(stream, streamInput);
 		assert(streamInput == "[");
 	}
 
+	// Members are normally written in the order they were reflected. Track the ordinal we expect to see next
+	// so that the name index only needs to be consulted when the stream's layout differs from ours.
+	size_t expectedOrdinal = 0;
+
 	while (streamInput != "]") {
 		// Read in the type.
-		stream >> streamInput;
+		text::readToken(stream, streamInput);
         assert(stream);
 
 		// Handle deserializing a NULL pointer. In this case, there will be no other
@@ -213,12 +287,18 @@ void ReflectionData::deserialize(ReflectedVariable *variable, std::istream &stre
 			continue;
 		}
 	
-		const ReflectedMember *member = this->member(streamInput);
+		const ReflectedMember *member = memberAt(expectedOrdinal);
+		if (!member || member->name() != streamInput) {
+			member = this->member(streamInput);
+		}
+
 		if (member) {
+			expectedOrdinal = member->ordinal() + 1;
+
 			if (member->isPointer()) {
 				// Read in the index for this pointer that corresponds to the pointer table.
 				PointerTable::TableIndex pointerIndex = 0;
-				stream >> pointerIndex;
+				text::readValue(stream, pointerIndex);
 				assert(pointerIndex >= 0);
 
 				void *offsetData = pointerOffset(variable->instanceData(), member->offset());
@@ -250,6 +330,1235 @@ void ReflectionData::deserialize(ReflectedVariable *variable, std::istream &stre
 		tableVariable = *variable;
 	}
 }
+
+const SerializationPlan &ReflectionData::plan() const
+{
+	std::call_once(m_planFlag, [this]() { buildPlan(); });
+	return m_plan;
+}
+
+const SerializationPlan &ReflectionData::columnPlan() const
+{
+	std::call_once(m_columnPlanFlag, [this]() { appendToPlan(m_columnPlan, 0, false); });
+	return m_columnPlan;
+}
+
+void ReflectionData::buildPlan() const
+{
+	appendToPlan(m_plan, 0, true);
+
+	m_plan.isBlockCopyable = m_isTriviallyCopyable &&
+	                         (m_plan.ops.size() == 1) &&
+	                         (m_plan.ops.front().kind == SerializationPlan::Op::Kind::Bytes) &&
+	                         (m_plan.ops.front().offset == 0) &&
+	                         (m_plan.ops.front().count == m_size);
+}
+
+void ReflectionData::appendToPlan(SerializationPlan &plan, size_t offset, bool merge) const
+{
+	using Op = SerializationPlan::Op;
+
+	// Containers have a dynamic layout so each one gets an operation of its own. Arrays of containers are merged
+	// into a single operation.
+	if (m_container) {
+		if (merge && !plan.ops.empty() && plan.ops.back().kind == Op::Kind::Container && plan.ops.back().data == this &&
+			(plan.ops.back().offset + plan.ops.back().count * m_size) == offset) {
+			++plan.ops.back().count;
+			return;
+		}
+
+		Op op;
+		op.kind = Op::Kind::Container;
+		op.offset = offset;
+		op.count = 1;
+		op.data = this;
+		plan.ops.push_back(op);
+		return;
+	}
+
+	// Primitive types know how to write themselves. Trivially copyable ones are plain bytes which can be
+	// merged with the previous operation if it directly precedes them in memory. String views are trivially
+	// copyable but refer to memory outside of the object so they need their own operation.
+	const bool isStringView = (this == &ReflectionDataCreator<std::string_view>::instance());
+	if (m_binarySerializeFunction) {
+		if (m_isTriviallyCopyable && !isStringView) {
+			if (merge && !plan.ops.empty() && plan.ops.back().kind == Op::Kind::Bytes &&
+				(plan.ops.back().offset + plan.ops.back().count) == offset) {
+				plan.ops.back().count += m_size;
+				return;
+			}
+
+			Op op;
+			op.kind = Op::Kind::Bytes;
+			op.offset = offset;
+			op.count = m_size;
+			plan.ops.push_back(op);
+			return;
+		}
+
+		// Consecutive strings (arrays) are also merged into a single operation.
+		Op::Kind kind = Op::Kind::Custom;
+		if (this == &ReflectionDataCreator<std::string>::instance()) {
+			kind = Op::Kind::String;
+		} else if (isStringView) {
+			kind = Op::Kind::StringView;
+		}
+		if (merge && !plan.ops.empty() && plan.ops.back().kind == kind && plan.ops.back().data == this &&
+			(plan.ops.back().offset + plan.ops.back().count * m_size) == offset) {
+			++plan.ops.back().count;
+			return;
+		}
+
+		Op op;
+		op.kind = kind;
+		op.offset = offset;
+		op.count = 1;
+		op.data = this;
+		plan.ops.push_back(op);
+		return;
+	}
+
+	// Parent members come first, both in memory and in the stream.
+	if (m_parent) {
+		m_parent->appendToPlan(plan, offset, merge);
+	}
+
+	for (auto &member : m_members) {
+		const ReflectionData *data = member->reflectionData();
+
+		// Pointers are written as their index in the pointer table.
+		if (member->isPointer()) {
+			Op op;
+			op.kind = Op::Kind::Pointer;
+			op.offset = offset + member->offset();
+			op.count = 1;
+			op.data = data;
+			plan.ops.push_back(op);
+			continue;
+		}
+
+		// Arrays and single values are handled the same way, a single value is simply an array of one element.
+		size_t baseTypeSize = data->size();
+		assert(baseTypeSize > 0);
+		size_t entryCount = member->size() / baseTypeSize;
+		const bool isLeaf = (data->m_binarySerializeFunction || data->m_container);
+
+		// Without merging, the entries of an array of objects share their operations so that each column holds a
+		// member of every entry. Operations which already repeat are kept per entry.
+		if (!merge && !isLeaf && entryCount > 1) {
+			SerializationPlan entryPlan;
+			data->appendToPlan(entryPlan, 0, false);
+
+			for (size_t ii = 0; ii < entryCount; ++ii) {
+				size_t elementOffset = offset + member->offset() + ii * baseTypeSize;
+				if (data->hasDataMembers()) {
+					plan.objects.push_back({ elementOffset, data });
+				}
+				for (auto &object : entryPlan.objects) {
+					plan.objects.push_back({ elementOffset + object.offset, object.data });
+				}
+			}
+
+			for (auto op : entryPlan.ops) {
+				op.offset += offset + member->offset();
+				if (op.repeat == 1) {
+					op.repeat = entryCount;
+					op.stride = baseTypeSize;
+					plan.ops.push_back(op);
+					continue;
+				}
+
+				for (size_t ii = 0; ii < entryCount; ++ii) {
+					plan.ops.push_back(op);
+					op.offset += baseTypeSize;
+				}
+			}
+			continue;
+		}
+
+		for (size_t ii = 0; ii < entryCount; ++ii) {
+			size_t elementOffset = offset + member->offset() + ii * baseTypeSize;
+
+			// Nested objects have their own entry in the pointer table so that pointers to them can be patched.
+			if (data->hasDataMembers()) {
+				SerializationPlan::Object object;
+				object.offset = elementOffset;
+				object.data = data;
+				plan.objects.push_back(object);
+			}
+
+			// The entries of an array of primitives or containers always make up a single operation.
+			data->appendToPlan(plan, elementOffset, merge || (isLeaf && ii > 0));
+		}
+	}
+}
+
+void ReflectionData::serializeBinary(const ReflectedVariable *variable, BinaryRecordWriter &record, PointerTable &pointerTable) const
+{
+	assert(variable->instanceData() != nullptr);
+	const void *instanceData = variable->instanceData();
+	const SerializationPlan &plan = this->plan();
+
+	for (auto &object : plan.objects) {
+		ReflectedVariable nestedVariable(object.data, pointerOffset(instanceData, object.offset));
+		record.subobjects.push_back(pointerTable.index(nestedVariable));
+	}
+
+	for (auto &op : plan.ops) {
+		serializeOpBinary(op, instanceData, record, pointerTable);
+	}
+}
+
+void ReflectionData::deserializeBinary(ReflectedVariable *variable, BinaryRecordReader &record, PointerTable &pointerTable) const
+{
+	void *instanceData = const_cast<void *>(variable->instanceData());
+	const SerializationPlan &plan = this->plan();
+
+	for (auto &object : plan.objects) {
+		ReflectedVariable nestedVariable(object.data, pointerOffset(instanceData, object.offset));
+		pointerTable.setPointer(record.subobjects.read<uint64_t>(), nestedVariable);
+	}
+
+	for (auto &op : plan.ops) {
+		deserializeOpBinary(op, instanceData, record, pointerTable);
+	}
+}
+
+namespace {
+
+///
+/// Number of bytes of instances whose fixed-size columns are copied together, so that each instance is
+/// still cached when the next column reads from (or writes to) it.
+///
+constexpr size_t kColumnBatchBytes = 16 * 1024;
+
+///
+/// Copy the values of a Bytes operation of each instance into a column and back. A non-zero 'Size' is the
+/// size of each value known at compile time, which lets the copies become single loads and stores.
+///
+template<size_t Size>
+void gatherValues(char *column, const void *const *instances, size_t count, const SerializationPlan::Op &op)
+{
+	const size_t size = Size ? Size : op.count;
+	for (size_t instance = 0; instance < count; ++instance) {
+		const char *value = static_cast<const char *>(instances[instance]) + op.offset;
+		for (size_t ii = 0; ii < op.repeat; ++ii, value += op.stride, column += size) {
+			memcpy(column, value, Size ? Size : size);
+		}
+	}
+}
+
+template<size_t Size>
+void scatterValues(const char *column, void *const *instances, size_t count, const SerializationPlan::Op &op)
+{
+	const size_t size = Size ? Size : op.count;
+	for (size_t instance = 0; instance < count; ++instance) {
+		char *value = static_cast<char *>(instances[instance]) + op.offset;
+		for (size_t ii = 0; ii < op.repeat; ++ii, value += op.stride, column += size) {
+			memcpy(value, column, Size ? Size : size);
+		}
+	}
+}
+
+} // namespace
+
+void ReflectionData::serializeColumnsBinary(const std::vector<const void *> &instances, BinaryRecordWriter &record, std::vector<ColumnSlice> &columns, PointerTable &pointerTable) const
+{
+	using Op = SerializationPlan::Op;
+	const SerializationPlan &plan = columnPlan();
+	columns.assign(plan.ops.size(), ColumnSlice());
+
+	// Columns of variable-size values are encoded one after the other, each instance in turn.
+	for (size_t column = 0; column < plan.ops.size(); ++column) {
+		const Op &op = plan.ops[column];
+		if (op.kind == Op::Kind::Bytes) {
+			continue;
+		}
+
+		columns[column].offset = record.payload.size();
+		for (const void *instance : instances) {
+			for (size_t ii = 0; ii < op.repeat; ++ii) {
+				serializeOpBinary(op, pointerOffset(instance, ii * op.stride), record, pointerTable);
+			}
+		}
+		columns[column].size = record.payload.size() - columns[column].offset;
+	}
+
+	// Fixed-size columns are laid out up front and filled a batch of instances at a time.
+	size_t total = 0;
+	for (size_t column = 0; column < plan.ops.size(); ++column) {
+		const Op &op = plan.ops[column];
+		if (op.kind == Op::Kind::Bytes) {
+			columns[column].offset = record.payload.size() + total;
+			columns[column].size = instances.size() * op.repeat * op.count;
+			total += columns[column].size;
+		}
+	}
+	if (total == 0) {
+		return;
+	}
+
+	const size_t start = record.payload.size();
+	char *payload = record.payload.append(total);
+	const size_t batch = std::max<size_t>(1, kColumnBatchBytes / m_size);
+	for (size_t first = 0; first < instances.size(); first += batch) {
+		size_t count = std::min(batch, instances.size() - first);
+		for (size_t column = 0; column < plan.ops.size(); ++column) {
+			const Op &op = plan.ops[column];
+			if (op.kind != Op::Kind::Bytes) {
+				continue;
+			}
+
+			char *values = payload + (columns[column].offset - start) + first * op.repeat * op.count;
+			switch (op.count) {
+				case 4:  gatherValues<4>(values, instances.data() + first, count, op); break;
+				case 8:  gatherValues<8>(values, instances.data() + first, count, op); break;
+				default: gatherValues<0>(values, instances.data() + first, count, op); break;
+			}
+		}
+	}
+}
+
+void ReflectionData::deserializeColumnsBinary(const std::vector<void *> &instances, const std::vector<BinaryReader> &columns, BinaryRecordReader &record, PointerTable &pointerTable) const
+{
+	using Op = SerializationPlan::Op;
+	const SerializationPlan &plan = columnPlan();
+	assert(columns.size() == plan.ops.size());
+
+	// Decoded in the order they were encoded, so the indices of container elements are read back in order.
+	for (size_t column = 0; column < plan.ops.size(); ++column) {
+		const Op &op = plan.ops[column];
+		if (op.kind == Op::Kind::Bytes) {
+			assert(columns[column].remaining() == instances.size() * op.repeat * op.count);
+			continue;
+		}
+
+		record.payload = columns[column];
+		for (void *instance : instances) {
+			for (size_t ii = 0; ii < op.repeat; ++ii) {
+				deserializeOpBinary(op, pointerOffset(instance, ii * op.stride), record, pointerTable);
+			}
+		}
+		assert(record.payload.atEnd());
+	}
+
+	const size_t batch = std::max<size_t>(1, kColumnBatchBytes / m_size);
+	for (size_t first = 0; first < instances.size(); first += batch) {
+		size_t count = std::min(batch, instances.size() - first);
+		for (size_t column = 0; column < plan.ops.size(); ++column) {
+			const Op &op = plan.ops[column];
+			if (op.kind != Op::Kind::Bytes) {
+				continue;
+			}
+
+			const char *values = columns[column].position() + first * op.repeat * op.count;
+			switch (op.count) {
+				case 4:  scatterValues<4>(values, instances.data() + first, count, op); break;
+				case 8:  scatterValues<8>(values, instances.data() + first, count, op); break;
+				default: scatterValues<0>(values, instances.data() + first, count, op); break;
+			}
+		}
+	}
+}
+
+void ReflectionData::serializeOpBinary(const SerializationPlan::Op &op, const void *instanceData, BinaryRecordWriter &record, PointerTable &pointerTable)
+{
+	using Op = SerializationPlan::Op;
+
+	void *data = pointerOffset(instanceData, op.offset);
+	switch (op.kind) {
+		case Op::Kind::Bytes:
+			record.payload.write(data, op.count);
+			break;
+
+		case Op::Kind::String:
+			for (size_t ii = 0; ii < op.count; ++ii) {
+				record.payload.writeString(static_cast<const std::string *>(data)[ii]);
+			}
+			break;
+
+		case Op::Kind::StringView:
+			for (size_t ii = 0; ii < op.count; ++ii) {
+				record.payload.writeString(static_cast<const std::string_view *>(data)[ii]);
+			}
+			break;
+
+		case Op::Kind::Pointer:
+		{
+			ReflectedVariable resolvedPointer(op.data, *static_cast<void **>(data));
+			record.payload.write<uint64_t>(pointerTable.index(resolvedPointer));
+			break;
+		}
+
+		case Op::Kind::Custom:
+			for (size_t ii = 0; ii < op.count; ++ii) {
+				ReflectedVariable element(op.data, pointerOffset(data, ii * op.data->size()));
+				op.data->m_binarySerializeFunction(&element, record.payload);
+			}
+			break;
+
+		case Op::Kind::Container:
+			for (size_t ii = 0; ii < op.count; ++ii) {
+				op.data->serializeContainerBinary(pointerOffset(data, ii * op.data->size()), record, pointerTable);
+			}
+			break;
+	}
+}
+
+void ReflectionData::deserializeOpBinary(const SerializationPlan::Op &op, void *instanceData, BinaryRecordReader &record, PointerTable &pointerTable)
+{
+	using Op = SerializationPlan::Op;
+
+	void *data = pointerOffset(instanceData, op.offset);
+	switch (op.kind) {
+		case Op::Kind::Bytes:
+			record.payload.read(data, op.count);
+			break;
+
+		case Op::Kind::String:
+			for (size_t ii = 0; ii < op.count; ++ii) {
+				record.payload.readString(static_cast<std::string *>(data)[ii]);
+			}
+			break;
+
+		case Op::Kind::StringView:
+			// Views can only point into the source memory when it lives on after deserialization (see
+			// MappedSnapshot), otherwise their characters are kept by the allocator.
+			for (size_t ii = 0; ii < op.count; ++ii) {
+				std::string_view view = record.payload.readStringView();
+				static_cast<std::string_view *>(data)[ii] = record.persistent ? view : pointerTable.keepCharacters(view);
+			}
+			break;
+
+		case Op::Kind::Pointer:
+		{
+			uint64_t pointerIndex = record.payload.read<uint64_t>();
+			if (record.deferPointers) {
+				// Park the index in the pointer itself, patchBinaryPointers() swaps it for the address.
+				*static_cast<uintptr_t *>(data) = static_cast<uintptr_t>(pointerIndex);
+				break;
+			}
+
+			// Add this pointer to the patch table to deffer resolving it until the pointer table
+			// has been entirely deserialized.
+			ReflectedVariable memberVariable(op.data, data);
+			pointerTable.addPatchPointer(pointerIndex, memberVariable);
+			break;
+		}
+
+		case Op::Kind::Custom:
+			for (size_t ii = 0; ii < op.count; ++ii) {
+				ReflectedVariable element(op.data, pointerOffset(data, ii * op.data->size()));
+				op.data->m_binaryDeserializeFunction(&element, record.payload);
+			}
+			break;
+
+		case Op::Kind::Container:
+			for (size_t ii = 0; ii < op.count; ++ii) {
+				op.data->deserializeContainerBinary(pointerOffset(data, ii * op.data->size()), record, pointerTable);
+			}
+			break;
+	}
+}
+
+void ReflectionData::patchBinaryPointers(const ReflectedVariable *variable, PointerTable &pointerTable) const
+{
+	using Op = SerializationPlan::Op;
+
+	const void *instanceData = variable->instanceData();
+	for (auto &op : plan().ops) {
+		if (op.kind == Op::Kind::Pointer) {
+			void **pointer = static_cast<void **>(pointerOffset(instanceData, op.offset));
+			uintptr_t pointerIndex = *reinterpret_cast<uintptr_t *>(pointer);
+			*pointer = const_cast<void *>(pointerTable.pointer(pointerIndex).instanceData());
+		} else if (op.kind == Op::Kind::Container) {
+			for (size_t ii = 0; ii < op.count; ++ii) {
+				op.data->patchContainerPointers(pointerOffset(instanceData, op.offset + ii * op.data->size()), pointerTable);
+			}
+		}
+	}
+}
+
+void ReflectionData::hash(const ReflectedVariable *variable, Hasher &hasher, PointerTable &pointerTable) const
+{
+	using Op = SerializationPlan::Op;
+
+	const void *instanceData = variable->instanceData();
+	for (auto &op : plan().ops) {
+		void *data = pointerOffset(instanceData, op.offset);
+		switch (op.kind) {
+			case Op::Kind::Bytes:
+				hasher.update(data, op.count);
+				break;
+
+			case Op::Kind::String:
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					const std::string &string = static_cast<const std::string *>(data)[ii];
+					hasher.add<uint64_t>(string.size());
+					hasher.update(string.data(), string.size());
+				}
+				break;
+
+			case Op::Kind::StringView:
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					std::string_view string = static_cast<const std::string_view *>(data)[ii];
+					hasher.add<uint64_t>(string.size());
+					hasher.update(string.data(), string.size());
+				}
+				break;
+
+			case Op::Kind::Pointer:
+			{
+				ReflectedVariable resolvedPointer(op.data, *static_cast<void **>(data));
+				hasher.add<uint64_t>(pointerTable.index(resolvedPointer));
+				break;
+			}
+
+			case Op::Kind::Custom:
+			{
+				// Only the type knows which of its bytes are meaningful, hash its binary encoding instead.
+				BinaryWriter writer;
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					ReflectedVariable element(op.data, pointerOffset(data, ii * op.data->size()));
+					op.data->m_binarySerializeFunction(&element, writer);
+				}
+				hasher.update(writer.data(), writer.size());
+				break;
+			}
+
+			case Op::Kind::Container:
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					op.data->hashContainer(pointerOffset(data, ii * op.data->size()), hasher, pointerTable);
+				}
+				break;
+		}
+	}
+}
+
+void ReflectionData::clone(const ReflectedVariable *source, ReflectedVariable *target, PointerTable &sourceTable, PointerTable &targetTable) const
+{
+	using Op = SerializationPlan::Op;
+
+	const void *sourceData = source->instanceData();
+	const void *targetData = target->instanceData();
+	const SerializationPlan &plan = this->plan();
+
+	PointerTable::TableIndex objectIndex = 0;
+	for (auto &object : plan.objects) {
+		ReflectedVariable sourceObject(object.data, pointerOffset(sourceData, object.offset));
+		objectIndex = sourceTable.index(sourceObject, objectIndex + 1);
+		targetTable.setPointer(objectIndex, ReflectedVariable(object.data, pointerOffset(targetData, object.offset)));
+	}
+
+	for (auto &op : plan.ops) {
+		void *from = pointerOffset(sourceData, op.offset);
+		void *to = pointerOffset(targetData, op.offset);
+		switch (op.kind) {
+			case Op::Kind::Bytes:
+				memcpy(to, from, op.count);
+				break;
+
+			case Op::Kind::String:
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					static_cast<std::string *>(to)[ii] = static_cast<const std::string *>(from)[ii];
+				}
+				break;
+
+			case Op::Kind::StringView:
+				// The copy views the same characters as the source.
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					static_cast<std::string_view *>(to)[ii] = static_cast<const std::string_view *>(from)[ii];
+				}
+				break;
+
+			case Op::Kind::Pointer:
+			{
+				ReflectedVariable resolvedPointer(op.data, *static_cast<void **>(from));
+				ReflectedVariable memberVariable(op.data, to);
+				targetTable.addPatchPointer(sourceTable.index(resolvedPointer), memberVariable);
+				break;
+			}
+
+			case Op::Kind::Custom:
+			{
+				// Only the type knows how to copy itself, go through its binary encoding.
+				BinaryWriter writer;
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					ReflectedVariable element(op.data, pointerOffset(from, ii * op.data->size()));
+					op.data->m_binarySerializeFunction(&element, writer);
+				}
+
+				BinaryReader reader(writer.data(), writer.size());
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					ReflectedVariable element(op.data, pointerOffset(to, ii * op.data->size()));
+					op.data->m_binaryDeserializeFunction(&element, reader);
+				}
+				break;
+			}
+
+			case Op::Kind::Container:
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					size_t offset = ii * op.data->size();
+					op.data->cloneContainer(pointerOffset(from, offset), pointerOffset(to, offset), sourceTable, targetTable);
+				}
+				break;
+		}
+	}
+}
+
+bool ReflectionData::equals(const void *lhs, const void *rhs, GraphComparer &comparer) const
+{
+	using Op = SerializationPlan::Op;
+
+	const SerializationPlan &plan = this->plan();
+	for (auto &object : plan.objects) {
+		if (!comparer.matchObject(object.data, pointerOffset(lhs, object.offset), pointerOffset(rhs, object.offset))) {
+			return false;
+		}
+	}
+
+	for (auto &op : plan.ops) {
+		const void *lhsData = pointerOffset(lhs, op.offset);
+		const void *rhsData = pointerOffset(rhs, op.offset);
+		switch (op.kind) {
+			case Op::Kind::Bytes:
+				if (memcmp(lhsData, rhsData, op.count) != 0) {
+					return false;
+				}
+				break;
+
+			case Op::Kind::String:
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					if (static_cast<const std::string *>(lhsData)[ii] != static_cast<const std::string *>(rhsData)[ii]) {
+						return false;
+					}
+				}
+				break;
+
+			case Op::Kind::StringView:
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					if (static_cast<const std::string_view *>(lhsData)[ii] != static_cast<const std::string_view *>(rhsData)[ii]) {
+						return false;
+					}
+				}
+				break;
+
+			case Op::Kind::Pointer:
+				if (!comparer.matchPointer(op.data, *static_cast<void * const *>(lhsData), *static_cast<void * const *>(rhsData), lhsData)) {
+					return false;
+				}
+				break;
+
+			case Op::Kind::Custom:
+			{
+				// Only the type knows which of its bytes are meaningful, compare the binary encodings instead.
+				BinaryWriter lhsWriter;
+				BinaryWriter rhsWriter;
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					ReflectedVariable lhsElement(op.data, pointerOffset(lhsData, ii * op.data->size()));
+					ReflectedVariable rhsElement(op.data, pointerOffset(rhsData, ii * op.data->size()));
+					op.data->m_binarySerializeFunction(&lhsElement, lhsWriter);
+					op.data->m_binarySerializeFunction(&rhsElement, rhsWriter);
+				}
+				if (lhsWriter.size() != rhsWriter.size() || memcmp(lhsWriter.data(), rhsWriter.data(), lhsWriter.size()) != 0) {
+					return false;
+				}
+				break;
+			}
+
+			case Op::Kind::Container:
+				for (size_t ii = 0; ii < op.count; ++ii) {
+					size_t offset = ii * op.data->size();
+					if (!op.data->equalsContainer(pointerOffset(lhsData, offset), pointerOffset(rhsData, offset), comparer)) {
+						return false;
+					}
+				}
+				break;
+		}
+	}
+
+	return true;
+}
+
+void ReflectionData::diff(const void *lhs, const void *rhs, const std::string &path, GraphComparer &comparer) const
+{
+	// Members inherited from a parent type come first, just like in the serialized forms.
+	if (m_parent) {
+		m_parent->diff(lhs, rhs, path, comparer);
+	}
+
+	for (auto &member : m_members) {
+		const ReflectionData *data = member->reflectionData();
+		size_t count = member->isPointer() ? 1 : member->size() / data->size();
+		for (size_t ii = 0; ii < count && !comparer.finished(); ++ii) {
+			std::string memberPath = path.empty() ? member->name() : path + "." + member->name();
+			if (count > 1) {
+				memberPath += "[" + std::to_string(ii) + "]";
+			}
+
+			size_t offset = member->offset() + ii * data->size();
+			data->diffElement(pointerOffset(lhs, offset), pointerOffset(rhs, offset), member->isPointer(), memberPath, comparer);
+		}
+	}
+}
+
+bool ReflectionData::findMemberPath(const void *object, const void *slot, std::string &path) const
+{
+	if (m_parent && m_parent->findMemberPath(object, slot, path)) {
+		return true;
+	}
+
+	for (auto &member : m_members) {
+		const ReflectionData *data = member->reflectionData();
+		size_t count = member->isPointer() ? 1 : member->size() / data->size();
+		for (size_t ii = 0; ii < count; ++ii) {
+			std::string memberPath = member->name();
+			if (count > 1) {
+				memberPath += "[" + std::to_string(ii) + "]";
+			}
+
+			if (data->findElementPath(pointerOffset(object, member->offset() + ii * data->size()), member->isPointer(), slot, memberPath)) {
+				path = memberPath;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void ReflectionData::serializeMemberBinary(const ReflectedVariable *variable, const ReflectedMember *member, BinaryRecordWriter &record, PointerTable &pointerTable)
+{
+	const ReflectionData *data = member->reflectionData();
+	size_t count = member->isPointer() ? 1 : member->size() / data->size();
+	for (size_t ii = 0; ii < count; ++ii) {
+		void *element = pointerOffset(variable->instanceData(), member->offset() + ii * data->size());
+		data->serializeElementBinary(element, member->isPointer(), record, pointerTable);
+	}
+}
+
+void ReflectionData::deserializeMemberBinary(ReflectedVariable *variable, const ReflectedMember *member, BinaryRecordReader &record, PointerTable &pointerTable)
+{
+	const ReflectionData *data = member->reflectionData();
+	size_t count = member->isPointer() ? 1 : member->size() / data->size();
+	for (size_t ii = 0; ii < count; ++ii) {
+		void *element = pointerOffset(variable->instanceData(), member->offset() + ii * data->size());
+		data->deserializeElementBinary(element, member->isPointer(), record, pointerTable);
+	}
+}
+
+void ReflectionData::hashElement(const void *element, bool isPointer, Hasher &hasher, PointerTable &pointerTable) const
+{
+	if (isPointer) {
+		ReflectedVariable resolvedPointer(this, *static_cast<void * const *>(element));
+		hasher.add<uint64_t>(pointerTable.index(resolvedPointer));
+		return;
+	}
+
+	ReflectedVariable elementVariable(this, const_cast<void *>(element));
+	hash(&elementVariable, hasher, pointerTable);
+}
+
+void ReflectionData::hashContainer(const void *container, Hasher &hasher, PointerTable &pointerTable) const
+{
+	const ContainerInfo &info = *m_container;
+	const ReflectionData *element = info.element;
+
+	size_t count = info.size(container);
+	hasher.add<uint64_t>(count);
+
+	if (info.isContiguous() && !info.elementIsPointer && element->isBlockCopyable()) {
+		hasher.update(info.data(container), count * info.elementSize);
+		return;
+	}
+
+	info.forEachElement(container, [&](const void *key, void *value) {
+		if (key) {
+			info.key->hashElement(key, false, hasher, pointerTable);
+		}
+		element->hashElement(value, info.elementIsPointer, hasher, pointerTable);
+	});
+}
+
+void ReflectionData::cloneElement(const void *source, void *target, bool isPointer, PointerTable &sourceTable, PointerTable &targetTable) const
+{
+	if (isPointer) {
+		ReflectedVariable resolvedPointer(this, *static_cast<void * const *>(source));
+		ReflectedVariable elementVariable(this, target);
+		targetTable.addPatchPointer(sourceTable.index(resolvedPointer), elementVariable);
+		return;
+	}
+
+	ReflectedVariable sourceVariable(this, const_cast<void *>(source));
+	ReflectedVariable targetVariable(this, target);
+	if (hasDataMembers()) {
+		targetTable.setPointer(sourceTable.index(sourceVariable), targetVariable);
+	}
+	clone(&sourceVariable, &targetVariable, sourceTable, targetTable);
+}
+
+void ReflectionData::cloneContainer(const void *source, void *target, PointerTable &sourceTable, PointerTable &targetTable) const
+{
+	const ContainerInfo &info = *m_container;
+	const ReflectionData *element = info.element;
+	size_t count = info.size(source);
+
+	if (!info.isContiguous()) {
+		info.clear(target);
+		info.forEach(source, [&](const void *key, void *value) {
+			void *targetValue = info.insert(target, [&](void *targetKey) { info.key->cloneElement(key, targetKey, false, sourceTable, targetTable); });
+			element->cloneElement(value, targetValue, info.elementIsPointer, sourceTable, targetTable);
+		});
+		return;
+	}
+
+	info.resize(target, count);
+	const char *sourceElements = static_cast<const char *>(info.data(source));
+	char *targetElements = static_cast<char *>(info.data(target));
+
+	// Contiguous elements which are plain bytes are copied as one block, elements which are objects
+	// (and their nested objects) still need to be registered in the table.
+	if (!info.elementIsPointer && element->isBlockCopyable()) {
+		if (count > 0) {
+			memcpy(targetElements, sourceElements, count * info.elementSize);
+		}
+
+		if (element->hasDataMembers()) {
+			const SerializationPlan &plan = element->plan();
+			PointerTable::TableIndex objectIndex = 0;
+			for (size_t ii = 0; ii < count; ++ii) {
+				size_t offset = ii * info.elementSize;
+				objectIndex = sourceTable.index(ReflectedVariable(element, const_cast<char *>(sourceElements) + offset), objectIndex + 1);
+				targetTable.setPointer(objectIndex, ReflectedVariable(element, targetElements + offset));
+				for (auto &object : plan.objects) {
+					ReflectedVariable sourceObject(object.data, const_cast<char *>(sourceElements) + offset + object.offset);
+					objectIndex = sourceTable.index(sourceObject, objectIndex + 1);
+					targetTable.setPointer(objectIndex, ReflectedVariable(object.data, targetElements + offset + object.offset));
+				}
+			}
+		}
+		return;
+	}
+
+	for (size_t ii = 0; ii < count; ++ii) {
+		size_t offset = ii * info.elementSize;
+		element->cloneElement(sourceElements + offset, targetElements + offset, info.elementIsPointer, sourceTable, targetTable);
+	}
+}
+
+bool ReflectionData::equalsElement(const void *lhs, const void *rhs, bool isPointer, GraphComparer &comparer) const
+{
+	if (isPointer) {
+		return comparer.matchPointer(this, *static_cast<void * const *>(lhs), *static_cast<void * const *>(rhs), lhs);
+	}
+
+	if (hasDataMembers() && !comparer.matchObject(this, lhs, rhs)) {
+		return false;
+	}
+	return equals(lhs, rhs, comparer);
+}
+
+bool ReflectionData::equalsContainer(const void *lhs, const void *rhs, GraphComparer &comparer) const
+{
+	const ContainerInfo &info = *m_container;
+	const ReflectionData *element = info.element;
+
+	size_t count = info.size(lhs);
+	if (count != info.size(rhs)) {
+		return false;
+	}
+
+	if (!info.isContiguous()) {
+		// Maps can only be walked with a visitor, gather one side so both can be walked together.
+		std::vector<std::pair<const void *, const void *>> rhsElements;
+		rhsElements.reserve(count);
+		info.forEach(rhs, [&](const void *key, void *value) { rhsElements.emplace_back(key, value); });
+
+		size_t index = 0;
+		bool equal = true;
+		info.forEach(lhs, [&](const void *key, void *value) {
+			const std::pair<const void *, const void *> &other = rhsElements[index++];
+			equal = equal && info.key->equalsElement(key, other.first, false, comparer) &&
+					element->equalsElement(value, other.second, info.elementIsPointer, comparer);
+		});
+		return equal;
+	}
+
+	const char *lhsElements = static_cast<const char *>(info.data(lhs));
+	const char *rhsElements = static_cast<const char *>(info.data(rhs));
+
+	// Contiguous elements which are plain bytes are compared as one block, elements which are objects
+	// (and their nested objects) still need to be paired.
+	if (!info.elementIsPointer && element->isBlockCopyable()) {
+		if (count > 0 && memcmp(lhsElements, rhsElements, count * info.elementSize) != 0) {
+			return false;
+		}
+
+		if (element->hasDataMembers()) {
+			const SerializationPlan &plan = element->plan();
+			for (size_t ii = 0; ii < count; ++ii) {
+				size_t offset = ii * info.elementSize;
+				if (!comparer.matchObject(element, lhsElements + offset, rhsElements + offset)) {
+					return false;
+				}
+				for (auto &object : plan.objects) {
+					if (!comparer.matchObject(object.data, lhsElements + offset + object.offset, rhsElements + offset + object.offset)) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	for (size_t ii = 0; ii < count; ++ii) {
+		size_t offset = ii * info.elementSize;
+		if (!element->equalsElement(lhsElements + offset, rhsElements + offset, info.elementIsPointer, comparer)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void ReflectionData::diffElement(const void *lhs, const void *rhs, bool isPointer, const std::string &path, GraphComparer &comparer) const
+{
+	if (isPointer) {
+		if (!comparer.matchPointer(this, *static_cast<void * const *>(lhs), *static_cast<void * const *>(rhs), lhs)) {
+			comparer.addDifference(path);
+		}
+	} else if (isContainer()) {
+		diffContainer(lhs, rhs, path, comparer);
+	} else if (hasDataMembers()) {
+		if (!comparer.matchObject(this, lhs, rhs)) {
+			comparer.addDifference(path);
+			return;
+		}
+		diff(lhs, rhs, path, comparer);
+	} else if (!equals(lhs, rhs, comparer)) {
+		comparer.addDifference(path);
+	}
+}
+
+void ReflectionData::diffContainer(const void *lhs, const void *rhs, const std::string &path, GraphComparer &comparer) const
+{
+	const ContainerInfo &info = *m_container;
+	const ReflectionData *element = info.element;
+
+	// Elements can't be paired up when the sizes differ, the container as a whole differs.
+	size_t count = info.size(lhs);
+	if (count != info.size(rhs)) {
+		comparer.addDifference(path);
+		return;
+	}
+
+	if (!info.isContiguous()) {
+		std::vector<std::pair<const void *, const void *>> rhsElements;
+		rhsElements.reserve(count);
+		info.forEach(rhs, [&](const void *key, void *value) { rhsElements.emplace_back(key, value); });
+
+		size_t index = 0;
+		info.forEach(lhs, [&](const void *key, void *value) {
+			const std::pair<const void *, const void *> &other = rhsElements[index++];
+			if (comparer.finished()) {
+				return;
+			}
+
+			// Values are only compared when the keys match, otherwise the entry as a whole differs.
+			std::string elementPath = path + "[" + info.key->describeKey(key) + "]";
+			if (!info.key->equalsElement(key, other.first, false, comparer)) {
+				comparer.addDifference(elementPath);
+				return;
+			}
+			element->diffElement(value, other.second, info.elementIsPointer, elementPath, comparer);
+		});
+		return;
+	}
+
+	const char *lhsElements = static_cast<const char *>(info.data(lhs));
+	const char *rhsElements = static_cast<const char *>(info.data(rhs));
+	for (size_t ii = 0; ii < count && !comparer.finished(); ++ii) {
+		size_t offset = ii * info.elementSize;
+		element->diffElement(lhsElements + offset, rhsElements + offset, info.elementIsPointer, path + "[" + std::to_string(ii) + "]", comparer);
+	}
+}
+
+bool ReflectionData::findElementPath(const void *element, bool isPointer, const void *slot, std::string &path) const
+{
+	if (isPointer) {
+		return (element == slot);
+	}
+
+	if (isContainer()) {
+		const ContainerInfo &info = *m_container;
+		if (!info.elementIsPointer && info.element->isBlockCopyable()) {
+			// Plain bytes can't hold pointers.
+			return false;
+		}
+
+		if (info.isContiguous() && info.elementIsPointer) {
+			const char *elements = static_cast<const char *>(info.data(element));
+			const char *address = static_cast<const char *>(slot);
+			if (address < elements || address >= elements + info.size(element) * info.elementSize) {
+				return false;
+			}
+		}
+
+		size_t index = 0;
+		bool found = false;
+		info.forEachElement(element, [&](const void *key, void *value) {
+			if (found) {
+				return;
+			}
+
+			std::string elementPath = path + "[" + (key ? info.key->describeKey(key) : std::to_string(index)) + "]";
+			++index;
+			if (info.element->findElementPath(value, info.elementIsPointer, slot, elementPath)) {
+				path = elementPath;
+				found = true;
+			}
+		});
+		return found;
+	}
+
+	if (hasDataMembers() && !isBlockCopyable()) {
+		std::string memberPath;
+		if (findMemberPath(element, slot, memberPath)) {
+			path += "." + memberPath;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::string ReflectionData::describeKey(const void *key) const
+{
+	if (m_name == "std::string") {
+		return "\"" + *static_cast<const std::string *>(key) + "\"";
+	}
+
+	if (m_serializeFunction) {
+		std::ostringstream stream;
+		ReflectedVariable keyVariable(this, const_cast<void *>(key));
+		m_serializeFunction(&keyVariable, stream);
+
+		std::string text = stream.str();
+		while (!text.empty() && isspace(static_cast<unsigned char>(text.back()))) {
+			text.pop_back();
+		}
+		return text;
+	}
+
+	return "?";
+}
+
+void ReflectionData::serializeElement(void *element, bool isPointer, std::ostream &stream, PointerTable &pointerTable, size_t padding) const
+{
+	if (isPointer) {
+		ReflectedVariable resolvedPointer(this, *static_cast<void **>(element));
+		text::writeValue(stream, pointerTable.index(resolvedPointer), '\n');
+		return;
+	}
+
+	// Elements which are objects have their own table entry and write their index like any other nested object.
+	ReflectedVariable elementVariable(this, element);
+	serialize(&elementVariable, stream, pointerTable, padding, false);
+}
+
+void ReflectionData::deserializeElement(void *element, bool isPointer, std::istream &stream, PointerTable &pointerTable) const
+{
+	if (isPointer) {
+		PointerTable::TableIndex pointerIndex = 0;
+		text::readValue(stream, pointerIndex);
+
+		ReflectedVariable elementVariable(this, element);
+		pointerTable.addPatchPointer(pointerIndex, elementVariable);
+		return;
+	}
+
+	ReflectedVariable elementVariable(this, element);
+	deserialize(&elementVariable, stream, pointerTable, false);
+}
+
+void ReflectionData::serializeElementBinary(void *element, bool isPointer, BinaryRecordWriter &record, PointerTable &pointerTable) const
+{
+	if (isPointer) {
+		ReflectedVariable resolvedPointer(this, *static_cast<void **>(element));
+		record.payload.write<uint64_t>(pointerTable.index(resolvedPointer));
+		return;
+	}
+
+	ReflectedVariable elementVariable(this, element);
+	if (hasDataMembers()) {
+		record.subobjects.push_back(pointerTable.index(elementVariable));
+	}
+	serializeBinary(&elementVariable, record, pointerTable);
+}
+
+void ReflectionData::deserializeElementBinary(void *element, bool isPointer, BinaryRecordReader &record, PointerTable &pointerTable) const
+{
+	if (isPointer) {
+		uint64_t pointerIndex = record.payload.read<uint64_t>();
+		if (record.deferPointers) {
+			*static_cast<uintptr_t *>(element) = static_cast<uintptr_t>(pointerIndex);
+			return;
+		}
+
+		ReflectedVariable elementVariable(this, element);
+		pointerTable.addPatchPointer(pointerIndex, elementVariable);
+		return;
+	}
+
+	ReflectedVariable elementVariable(this, element);
+	if (hasDataMembers()) {
+		pointerTable.setPointer(record.subobjects.read<uint64_t>(), elementVariable);
+	}
+	deserializeBinary(&elementVariable, record, pointerTable);
+}
+
+void ReflectionData::serializeContainer(void *container, std::ostream &stream, PointerTable &pointerTable, size_t padding) const
+{
+	const ContainerInfo &info = *m_container;
+	text::writeValue(stream, info.size(container), '\n');
+
+	++padding;
+	info.forEachElement(container, [&](const void *key, void *element) {
+		if (key) {
+			padStream(stream, padding);
+			info.key->serializeElement(const_cast<void *>(key), false, stream, pointerTable, padding);
+		}
+
+		padStream(stream, padding);
+		info.element->serializeElement(element, info.elementIsPointer, stream, pointerTable, padding);
+	});
+}
+
+void ReflectionData::deserializeContainer(void *container, std::istream &stream, PointerTable &pointerTable) const
+{
+	const ContainerInfo &info = *m_container;
+
+	size_t count = 0;
+	text::readValue(stream, count);
+	assert(stream);
+
+	if (info.isContiguous()) {
+		info.resize(container, count);
+		char *elements = static_cast<char *>(info.data(container));
+		for (size_t ii = 0; ii < count; ++ii) {
+			info.element->deserializeElement(elements + ii * info.elementSize, info.elementIsPointer, stream, pointerTable);
+		}
+	} else {
+		assert(!info.key->hasDataMembers());
+		info.clear(container);
+		for (size_t ii = 0; ii < count; ++ii) {
+			void *element = info.insert(container, [&](void *key) { info.key->deserializeElement(key, false, stream, pointerTable); });
+			info.element->deserializeElement(element, info.elementIsPointer, stream, pointerTable);
+		}
+	}
+}
+
+void ReflectionData::serializeContainerBinary(void *container, BinaryRecordWriter &record, PointerTable &pointerTable) const
+{
+	const ContainerInfo &info = *m_container;
+	const ReflectionData *element = info.element;
+
+	size_t count = info.size(container);
+	record.payload.write<uint64_t>(count);
+
+	// Contiguous elements which are plain bytes are written as one block. Elements which are objects still
+	// need their (and their nested objects') table indices written first.
+	if (info.isContiguous() && !info.elementIsPointer && element->isBlockCopyable()) {
+		char *elements = static_cast<char *>(info.data(container));
+		if (element->hasDataMembers()) {
+			const SerializationPlan &plan = element->plan();
+			for (size_t ii = 0; ii < count; ++ii) {
+				char *instance = elements + ii * info.elementSize;
+				record.subobjects.push_back(pointerTable.index(ReflectedVariable(element, instance)));
+				for (auto &object : plan.objects) {
+					record.subobjects.push_back(pointerTable.index(ReflectedVariable(object.data, instance + object.offset)));
+				}
+			}
+		}
+
+		if (count > 0) {
+			record.payload.write(elements, count * info.elementSize);
+		}
+		return;
+	}
+
+	info.forEachElement(container, [&](const void *key, void *value) {
+		if (key) {
+			info.key->serializeElementBinary(const_cast<void *>(key), false, record, pointerTable);
+		}
+		element->serializeElementBinary(value, info.elementIsPointer, record, pointerTable);
+	});
+}
+
+void ReflectionData::deserializeContainerBinary(void *container, BinaryRecordReader &record, PointerTable &pointerTable) const
+{
+	const ContainerInfo &info = *m_container;
+	const ReflectionData *element = info.element;
+
+	size_t count = static_cast<size_t>(record.payload.read<uint64_t>());
+
+	if (!info.isContiguous()) {
+		assert(!info.key->hasDataMembers());
+		info.clear(container);
+		for (size_t ii = 0; ii < count; ++ii) {
+			void *value = info.insert(container, [&](void *key) { info.key->deserializeElementBinary(key, false, record, pointerTable); });
+			element->deserializeElementBinary(value, info.elementIsPointer, record, pointerTable);
+		}
+		return;
+	}
+
+	// Size the storage once up front, the elements are then filled in place.
+	info.resize(container, count);
+	char *elements = static_cast<char *>(info.data(container));
+
+	if (!info.elementIsPointer && element->isBlockCopyable()) {
+		if (element->hasDataMembers()) {
+			const SerializationPlan &plan = element->plan();
+			for (size_t ii = 0; ii < count; ++ii) {
+				char *instance = elements + ii * info.elementSize;
+				pointerTable.setPointer(record.subobjects.read<uint64_t>(), ReflectedVariable(element, instance));
+				for (auto &object : plan.objects) {
+					pointerTable.setPointer(record.subobjects.read<uint64_t>(), ReflectedVariable(object.data, instance + object.offset));
+				}
+			}
+		}
+
+		if (count > 0) {
+			record.payload.read(elements, count * info.elementSize);
+		}
+		return;
+	}
+
+	for (size_t ii = 0; ii < count; ++ii) {
+		element->deserializeElementBinary(elements + ii * info.elementSize, info.elementIsPointer, record, pointerTable);
+	}
+}
+
+void ReflectionData::patchContainerPointers(void *container, PointerTable &pointerTable) const
+{
+	const ContainerInfo &info = *m_container;
+	const ReflectionData *element = info.element;
+
+	// Elements without pointers anywhere inside of them have nothing to patch.
+	if (!info.elementIsPointer && !element->hasDataMembers() && !element->isContainer()) {
+		return;
+	}
+
+	info.forEachElement(container, [&](const void *, void *value) {
+		if (info.elementIsPointer) {
+			void **pointer = static_cast<void **>(value);
+			uintptr_t pointerIndex = *reinterpret_cast<uintptr_t *>(pointer);
+			*pointer = const_cast<void *>(pointerTable.pointer(pointerIndex).instanceData());
+		} else {
+			ReflectedVariable elementVariable(element, value);
+			element->patchBinaryPointers(&elementVariable, pointerTable);
+		}
+	});
+}
     
 // ReflectionData implementation end ---------------------------------------------------------
 
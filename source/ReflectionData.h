@@ -9,11 +9,17 @@
 #pragma once
 
 #include "ReflectionDataManager.h"
+#include "SerializationPlan.h"
+#include "Instrumentation.h"
 
 #include <ostream>
 #include <string>
-#include <list>
+#include <vector>
+#include <unordered_map>
 #include <functional>
+#include <mutex>
+#include <new>
+#include <type_traits>
 
 ///
 /// Classes which contain reflected data members and
@@ -26,6 +32,13 @@ namespace carl {
 class ReflectedMember;
 class ReflectedVariable;
 class PointerTable;
+class BinaryWriter;
+class BinaryReader;
+struct BinaryRecordWriter;
+struct BinaryRecordReader;
+struct ContainerInfo;
+class Hasher;
+class GraphComparer;
 
 class ReflectionData
 {
@@ -37,8 +50,13 @@ public:
     /// Function pointer typedefs.
     ///
     typedef std::function<void *()> AllocateInstanceFunction;
+    typedef std::function<void(void *instance)> DestroyInstanceFunction;
+    typedef std::function<void *(void *memory)> ConstructInstanceFunction;
+    typedef std::function<void(void *instance)> DestructInstanceFunction;
     typedef std::function<void(const ReflectedVariable *variable, std::ostream &stream)> SerializeFunction;
     typedef std::function<void(ReflectedVariable *variable, std::istream &stream)> DeserializeFunction;
+    typedef std::function<void(const ReflectedVariable *variable, BinaryWriter &writer)> BinarySerializeFunction;
+    typedef std::function<void(ReflectedVariable *variable, BinaryReader &reader)> BinaryDeserializeFunction;
 
     ///
     /// Info struct to use for initializing this object.
@@ -47,8 +65,14 @@ public:
     {
         std::string name; ///< Name of this type.
         size_t      size; ///< Size of this type (in bytes).
+        size_t      alignment = 1; ///< Alignment requirement of this type (in bytes).
+        bool        isTriviallyCopyable = false; ///< If true, instances of this type can be copied with memcpy().
+        bool        isTriviallyDestructible = false; ///< If true, instances of this type do not need their destructor run.
 
         AllocateInstanceFunction allocateFunction; ///< Function to use for allocating an instance of this object.
+        DestroyInstanceFunction  destroyFunction;  ///< Function to use for destroying an instance created with allocateFunction.
+        ConstructInstanceFunction constructFunction; ///< Function to use for constructing an instance in caller provided memory.
+        DestructInstanceFunction  destructFunction;  ///< Function to use for destructing an instance created with constructFunction.
     };
     
     ///
@@ -72,6 +96,54 @@ public:
     ///
     inline size_t size() const { return m_size; }
 
+    ///
+    /// Get the alignment requirement of this type (in bytes).
+    ///
+    /// @return Alignment of this type.
+    ///
+    inline size_t alignment() const { return m_alignment; }
+
+    ///
+    /// Was this type trivially copyable (std::is_trivially_copyable) when it was registered?
+    ///
+    /// @return If true, instances of this type can be copied with memcpy().
+    ///
+    inline bool isTriviallyCopyable() const { return m_isTriviallyCopyable; }
+
+    ///
+    /// Was this type trivially destructible (std::is_trivially_destructible) when it was registered?
+    ///
+    /// @return If true, the memory of an instance can be released without running its destructor.
+    ///
+    inline bool isTriviallyDestructible() const { return m_isTriviallyDestructible; }
+
+    ///
+    /// Determine if an instance of this type can be written to and read from the binary format as a single block
+    /// of memory. This is the case for trivially copyable types with no reflected pointers whose reflected members
+    /// (including those of parent types) cover the entire object without gaps.
+    ///
+    /// @return If true, this type is serialized with a single copy in the binary format.
+    ///
+    inline bool isBlockCopyable() const { return plan().isBlockCopyable; }
+
+    ///
+    /// Get the flattened serialization plan for this type, building it on first use. The plan is built lazily
+    /// as member types may not be fully registered when this type is.
+    ///
+    /// @return Serialization plan for this type.
+    ///
+    const SerializationPlan &plan() const;
+
+    ///
+    /// Get the plan used by the columnar format (see SerializationFormat::Columnar), building it on first use.
+    /// It holds the same values as plan() in the same order, but only the entries of an array of leaf values
+    /// (primitives, strings, containers) are merged, so every member is an operation and therefore a column of
+    /// its own. The entries of an array of objects share operations which repeat for each entry.
+    ///
+    /// @return Columnar serialization plan for this type.
+    ///
+    const SerializationPlan &columnPlan() const;
+
     ///
     /// Declare the parent type to this type (for inheritance).
     ///
@@ -85,15 +157,30 @@ public:
     /// @return If true, this type has a parent.
     ///
     inline bool hasParent() const { return (m_parent != nullptr); }
+
+    ///
+    /// Get the parent type of this type (for inheritance).
+    ///
+    /// @return Parent of this type, nullptr if this type has no parent.
+    ///
+    inline const ReflectionData *parent() const { return m_parent; }
     
     ///
-    /// Add a member to this type.
+    /// Add a member to this type. The member is assigned the next ordinal and added to the
+    /// name index used by member().
     ///
     /// @param member New member info to add to this type.
     ///
-    inline void addMember(const ReflectedMember *member) {
-        m_members.push_back(const_cast<ReflectedMember *>(member));
-    }
+    void addMember(const ReflectedMember *member);
+
+    ///
+    /// Add another name a member can be found by with member(). Used to keep reading data written before a
+    /// member was renamed (see CARL_DECLARE_MEMBER_ALIAS).
+    ///
+    /// @param name Current name of the member.
+    /// @param alias Previous name of the member.
+    ///
+    void addMemberAlias(const std::string &name, const std::string &alias);
     
     ///
     /// Determine if this type has members (a class/struct) or
@@ -103,6 +190,20 @@ public:
     ///
     inline bool hasDataMembers() const { return !(m_members.empty()); }
 
+    ///
+    /// Determine if this type is a standard container (see ReflectionContainers.h).
+    ///
+    /// @return If true, this type is a container and container() describes its elements.
+    ///
+    inline bool isContainer() const { return (m_container != nullptr); }
+
+    ///
+    /// Get the description of this container type.
+    ///
+    /// @return Container description, nullptr if this type is not a container.
+    ///
+    inline const ContainerInfo *container() const { return m_container; }
+
     ///
     /// Find a specific member by name for this object. 
     ///
@@ -110,11 +211,19 @@ public:
     /// @return A pointer to the found member, nullptr if not found.
     /// 
     const ReflectedMember *member(const std::string &name) const;
+
+    ///
+    /// Get a specific member by its ordinal (the order in which it was reflected).
+    ///
+    /// @param ordinal Ordinal of the member.
+    /// @return A pointer to the member, nullptr if the ordinal is out of range.
+    ///
+    inline const ReflectedMember *memberAt(size_t ordinal) const { return (ordinal < m_members.size()) ? m_members[ordinal] : nullptr; }
     
     ///
-    /// Storage list for reflected members of this type.
+    /// Storage list for reflected members of this type (in ordinal order).
     ///
-    using Members = std::list<ReflectedMember *>;
+    using Members = std::vector<ReflectedMember *>;
 
     ///
     /// Get access to the members of this type. If members exist
@@ -130,6 +239,28 @@ public:
     /// @return A created instance for this type.
     ///
     inline void *allocateInstance() const { return m_allocateInstanceFunction(); }
+
+    ///
+    /// Destroy an instance previously created with allocateInstance().
+    ///
+    /// @param instance Instance to destroy.
+    ///
+    inline void destroyInstance(void *instance) const { m_destroyInstanceFunction(instance); }
+
+    ///
+    /// Construct an instance of this type in memory provided by the caller.
+    ///
+    /// @param memory Memory to construct the instance in. Must be at least size() bytes and aligned to alignment().
+    /// @return The constructed instance.
+    ///
+    inline void *constructInstance(void *memory) const { return m_constructInstanceFunction(memory); }
+
+    ///
+    /// Run the destructor of an instance created with constructInstance() without releasing its memory.
+    ///
+    /// @param instance Instance to destruct.
+    ///
+    inline void destructInstance(void *instance) const { m_destructInstanceFunction(instance); }
     
     ///
     /// Serialize the reflected variable to the stream.
@@ -148,8 +279,156 @@ public:
     /// @param stream Input stream to serialize from.
     /// @param pointerTable Table to read from when coming across pointer types.
     /// @param isArray If true, we're currently deserializing elements of an array (don't try to read the pointer index as there isn't one per array element).
+    /// @param recordIndex If not null, the pointer table index and type name that start this record have already been read
+    ///                    from the stream (by the pointer table) and this is the index that was read.
+    ///
+    void deserialize(ReflectedVariable *variable, std::istream &stream, PointerTable &pointerTable, bool isArray = false, const size_t *recordIndex = nullptr) const;
+
+    ///
+    /// Serialize the reflected variable into a binary record. Parent members are written first, followed by the
+    /// members of this type. No names are written; the reader relies on the registered reflection data instead.
+    ///
+    /// @param variable Reflected variable to serialize.
+    /// @param record Record to append the member data and nested object indices to.
+    /// @param pointerTable Table to read indices from when coming across pointer types.
+    ///
+    void serializeBinary(const ReflectedVariable *variable, BinaryRecordWriter &record, PointerTable &pointerTable) const;
+
+    ///
+    /// Deserialize the reflected variable from a binary record written by serializeBinary().
+    ///
+    /// @param variable Reflected variable to deserialize into.
+    /// @param record Record to read the member data and nested object indices from.
+    /// @param pointerTable Table to register nested objects and pointers to patch with.
+    ///
+    void deserializeBinary(ReflectedVariable *variable, BinaryRecordReader &record, PointerTable &pointerTable) const;
+
+    ///
+    /// Resolve the pointers of a variable deserialized with BinaryRecordReader::deferPointers set. Every entry of
+    /// the pointer table must have been deserialized first.
+    ///
+    /// @param variable Deserialized variable whose pointers currently hold table indices.
+    /// @param pointerTable Table to resolve the indices with.
+    ///
+    void patchBinaryPointers(const ReflectedVariable *variable, PointerTable &pointerTable) const;
+
+    ///
+    /// Add the reflected members of a variable to a structural hash (see ReflectedVariable::hash()). Members are walked
+    /// in binary serialization order, runs of plain bytes are hashed as a single block and pointers are hashed as
+    /// their table index.
+    ///
+    /// @param variable Reflected variable to hash.
+    /// @param hasher Hash to add the members to.
+    /// @param pointerTable Table to read indices from when coming across pointer types.
+    ///
+    void hash(const ReflectedVariable *variable, Hasher &hasher, PointerTable &pointerTable) const;
+
+    ///
+    /// Copy the reflected members of a variable into another instance of the same type (see ReflectedVariable::deepClone()).
+    /// Members are walked in binary serialization order and runs of plain bytes are copied as a single block. Nested
+    /// objects of the copy are registered in 'targetTable' under the index of their source and pointers are queued
+    /// to be patched once every object has been copied.
+    ///
+    /// @param source Reflected variable to copy from.
+    /// @param target Reflected variable to copy into.
+    /// @param sourceTable Populated table of the source graph.
+    /// @param targetTable Table of the copied graph.
+    ///
+    void clone(const ReflectedVariable *source, ReflectedVariable *target, PointerTable &sourceTable, PointerTable &targetTable) const;
+
+    ///
+    /// Compare two instances of this type using the serialization plan (see GraphComparer). Runs of plain bytes
+    /// are compared as a single block and pointers are matched through the comparer. No differences are recorded.
+    ///
+    /// @param lhs First instance.
+    /// @param rhs Second instance.
+    /// @param comparer Comparison in progress.
+    /// @return If true, the instances are equal.
+    ///
+    bool equals(const void *lhs, const void *rhs, GraphComparer &comparer) const;
+
+    ///
+    /// Compare two instances of this type member by member and record the path of every differing member with
+    /// the comparer (or only the first one, see GraphComparer::finished()).
+    ///
+    /// @param lhs First instance.
+    /// @param rhs Second instance.
+    /// @param path Path of the instances, member paths are appended to it.
+    /// @param comparer Comparison in progress.
+    ///
+    void diff(const void *lhs, const void *rhs, const std::string &path, GraphComparer &comparer) const;
+
+    ///
+    /// Find the path of a pointer held by an instance of this type (directly, in a nested object or in a container).
+    ///
+    /// @param object Instance to search.
+    /// @param slot Address of the pointer to find.
+    /// @param path Set to the path of the pointer relative to 'object' if found.
+    /// @return If true, the pointer was found.
+    ///
+    bool findMemberPath(const void *object, const void *slot, std::string &path) const;
+
+    ///
+    /// Serialize a single member of a variable into a binary record, encoded exactly as serializeBinary() encodes it.
+    /// Used to write individual members to deltas (see DeltaBaseline).
+    ///
+    /// @param variable Variable whose member should be serialized.
+    /// @param member Member to serialize. May be a member of a parent type of the variable's type.
+    /// @param record Record to append the member data and nested object indices to.
+    /// @param pointerTable Table to read indices from when coming across pointer types.
+    ///
+    static void serializeMemberBinary(const ReflectedVariable *variable, const ReflectedMember *member, BinaryRecordWriter &record, PointerTable &pointerTable);
+
+    ///
+    /// Deserialize a single member written by serializeMemberBinary().
+    ///
+    /// @param variable Variable whose member should be deserialized.
+    /// @param member Member to deserialize.
+    /// @param record Record to read the member data and nested object indices from.
+    /// @param pointerTable Table to register nested objects and pointers to patch with.
+    ///
+    static void deserializeMemberBinary(ReflectedVariable *variable, const ReflectedMember *member, BinaryRecordReader &record, PointerTable &pointerTable);
+
+    ///
+    /// Position of a column within the payload written by serializeColumnsBinary().
+    ///
+    struct ColumnSlice
+    {
+        size_t offset = 0; ///< Offset (in bytes) from the start of the payload.
+        size_t size = 0;   ///< Size of the column (in bytes).
+    };
+
     ///
-    void deserialize(ReflectedVariable *variable, std::istream &stream, PointerTable &pointerTable, bool isArray = false) const;
+    /// Serialize instances of this type a column at a time: each operation of columnPlan() is encoded for
+    /// every instance in turn (each repetition of it for arrays of objects), exactly as serializeBinary()
+    /// encodes it. Nested object indices are not written. Columns of variable-size values come first in the
+    /// payload, fixed-size columns are then filled a batch of instances at a time.
+    ///
+    /// @param instances Instances to encode.
+    /// @param record Record to append the columns (and the indices of container elements) to.
+    /// @param columns Set to the position of each column in the payload, in columnPlan() order.
+    /// @param pointerTable Table to read indices from when coming across pointer types.
+    ///
+    void serializeColumnsBinary(const std::vector<const void *> &instances, BinaryRecordWriter &record, std::vector<ColumnSlice> &columns, PointerTable &pointerTable) const;
+
+    ///
+    /// Deserialize columns written by serializeColumnsBinary().
+    ///
+    /// @param instances Instances to decode into.
+    /// @param columns Reader over each column, in columnPlan() order.
+    /// @param record Record to read the indices of container elements from.
+    /// @param pointerTable Table to register nested objects and pointers to patch with.
+    ///
+    void deserializeColumnsBinary(const std::vector<void *> &instances, const std::vector<BinaryReader> &columns, BinaryRecordReader &record, PointerTable &pointerTable) const;
+
+#if CARL_INSTRUMENTATION
+    ///
+    /// Get the instrumentation counters of this type (see Instrumentation.h).
+    ///
+    /// @return Counters of this type.
+    ///
+    inline TypeCounters &counters() const { return m_counters; }
+#endif
     
     ///
     /// Set the serialization function. Some types (such as the primitive types defined in ReflectionPrimitiveTypes.h) know
@@ -166,18 +445,149 @@ public:
     /// @param function Function to use for deserialization of this type.
     ///
     inline void setDeserializeFunction(DeserializeFunction function = nullptr) { m_deserializeFunction = function; }
+
+    ///
+    /// Set the binary serialization function. Same as setSerializeFunction() but used by the binary format.
+    ///
+    /// @param function Function to use for binary serialization of this type.
+    ///
+    inline void setBinarySerializeFunction(BinarySerializeFunction function = nullptr) { m_binarySerializeFunction = function; }
+
+    ///
+    /// Set the binary deserialization function. Same as setDeserializeFunction() but used by the binary format.
+    ///
+    /// @param function Function to use for binary deserialization of this type.
+    ///
+    inline void setBinaryDeserializeFunction(BinaryDeserializeFunction function = nullptr) { m_binaryDeserializeFunction = function; }
+
+    ///
+    /// Mark this type as a standard container. Containers serialize their elements themselves rather than
+    /// through members or the serialization functions above.
+    ///
+    /// @param container Description of the container. Must outlive this object.
+    ///
+    inline void setContainer(const ContainerInfo *container) { m_container = container; }
         
     private:
-        
+
+    friend class StreamSchema;
+    friend class StreamScanner;
+
+    ///
+    /// Build the serialization plan for this type. Only called once per type via plan().
+    ///
+    void buildPlan() const;
+
+    ///
+    /// Append the operations for an instance of this type located 'offset' bytes into an object to a plan.
+    ///
+    /// @param plan Plan to append to.
+    /// @param offset Offset (in bytes) of the instance from the start of the object the plan is for.
+    /// @param merge If true, operations on adjacent values are merged into one where possible.
+    ///
+    void appendToPlan(SerializationPlan &plan, size_t offset, bool merge) const;
+
+    ///
+    /// Binary serialization of a single plan operation of an instance.
+    ///
+    /// @param op Operation to process.
+    /// @param instanceData Instance the operation's offset is relative to.
+    /// @param record Record to write to (read from).
+    /// @param pointerTable Table to read indices from (register pointers to patch with).
+    ///
+    static void serializeOpBinary(const SerializationPlan::Op &op, const void *instanceData, BinaryRecordWriter &record, PointerTable &pointerTable);
+    static void deserializeOpBinary(const SerializationPlan::Op &op, void *instanceData, BinaryRecordReader &record, PointerTable &pointerTable);
+
+    ///
+    /// Text serialization of a single container element (or map key) whose type is this type.
+    ///
+    /// @param element Element to serialize. If 'isPointer' is set, this is the address of the pointer.
+    /// @param isPointer If true, the element is a pointer to an instance of this type.
+    /// @param stream Output stream to serialize to.
+    /// @param pointerTable Table to read indices from.
+    /// @param padding Padding of the element (in terms of tabs).
+    ///
+    void serializeElement(void *element, bool isPointer, std::ostream &stream, PointerTable &pointerTable, size_t padding) const;
+    void deserializeElement(void *element, bool isPointer, std::istream &stream, PointerTable &pointerTable) const;
+
+    ///
+    /// Binary serialization of a single container element (or map key) whose type is this type.
+    ///
+    void serializeElementBinary(void *element, bool isPointer, BinaryRecordWriter &record, PointerTable &pointerTable) const;
+    void deserializeElementBinary(void *element, bool isPointer, BinaryRecordReader &record, PointerTable &pointerTable) const;
+
+    ///
+    /// Serialization of a container whose type is this type. The element count is written first, followed by
+    /// the elements (keys and values alternate for maps).
+    ///
+    /// @param container Container instance.
+    ///
+    void serializeContainer(void *container, std::ostream &stream, PointerTable &pointerTable, size_t padding) const;
+    void deserializeContainer(void *container, std::istream &stream, PointerTable &pointerTable) const;
+    void serializeContainerBinary(void *container, BinaryRecordWriter &record, PointerTable &pointerTable) const;
+    void deserializeContainerBinary(void *container, BinaryRecordReader &record, PointerTable &pointerTable) const;
+    void patchContainerPointers(void *container, PointerTable &pointerTable) const;
+
+    ///
+    /// Structural hashing of a single container element (or map key) whose type is this type, and of a container
+    /// whose type is this type.
+    ///
+    void hashElement(const void *element, bool isPointer, Hasher &hasher, PointerTable &pointerTable) const;
+    void hashContainer(const void *container, Hasher &hasher, PointerTable &pointerTable) const;
+
+    ///
+    /// Copying of a single container element (or map key) whose type is this type, and of a container whose type
+    /// is this type.
+    ///
+    void cloneElement(const void *source, void *target, bool isPointer, PointerTable &sourceTable, PointerTable &targetTable) const;
+    void cloneContainer(const void *source, void *target, PointerTable &sourceTable, PointerTable &targetTable) const;
+
+    ///
+    /// Comparison of a single container element (or map key) whose type is this type, and of a container whose
+    /// type is this type (see equals(), diff() and findMemberPath()).
+    ///
+    bool equalsElement(const void *lhs, const void *rhs, bool isPointer, GraphComparer &comparer) const;
+    bool equalsContainer(const void *lhs, const void *rhs, GraphComparer &comparer) const;
+    void diffElement(const void *lhs, const void *rhs, bool isPointer, const std::string &path, GraphComparer &comparer) const;
+    void diffContainer(const void *lhs, const void *rhs, const std::string &path, GraphComparer &comparer) const;
+    bool findElementPath(const void *element, bool isPointer, const void *slot, std::string &path) const;
+
+    ///
+    /// Describe a map key whose type is this type for use in a member path.
+    ///
+    /// @param key Key to describe.
+    /// @return Text of the key.
+    ///
+    std::string describeKey(const void *key) const;
+
     Members                m_members;    ///< Members contained in this type.
+    std::unordered_map<std::string, const ReflectedMember *> m_memberIndex; ///< Members of this type stored by name.
     std::string            m_name;       ///< Name of this type.
     size_t                 m_size = 0;       ///< Size of this type in bytes.
+    size_t                 m_alignment = 1;  ///< Alignment of this type in bytes.
     const ReflectionData  *m_parent = nullptr;     ///< Parent object to this type (only populated if this is an inherited type).
+    bool                   m_isTriviallyCopyable = false; ///< If true, this type was trivially copyable at registration.
+    bool                   m_isTriviallyDestructible = false; ///< If true, this type was trivially destructible at registration.
+    const ContainerInfo   *m_container = nullptr; ///< Element description if this type is a standard container.
+
+    mutable SerializationPlan m_plan;     ///< Cached serialization plan of this type.
+    mutable std::once_flag    m_planFlag; ///< Guards building m_plan.
+    mutable SerializationPlan m_columnPlan;     ///< Cached columnar serialization plan of this type.
+    mutable std::once_flag    m_columnPlanFlag; ///< Guards building m_columnPlan.
+
+#if CARL_INSTRUMENTATION
+    mutable TypeCounters m_counters; ///< Instrumentation counters of this type.
+#endif
     
     SerializeFunction   m_serializeFunction = nullptr;   ///< Serialization function to use if this type is a primitive type defined in ReflectionPrimitiveTypes.h
     DeserializeFunction m_deserializeFunction = nullptr; ///< Deserialization function to use if this type is a primitive type defined in ReflectionPrimitiveTypes.h
+    BinarySerializeFunction   m_binarySerializeFunction = nullptr;   ///< Binary serialization function to use if this type is a primitive type defined in ReflectionPrimitiveTypes.h
+    BinaryDeserializeFunction m_binaryDeserializeFunction = nullptr; ///< Binary deserialization function to use if this type is a primitive type defined in ReflectionPrimitiveTypes.h
 
     AllocateInstanceFunction m_allocateInstanceFunction = nullptr; ///< Function to use to allocate an instance of this type (returns a void *).
+    DestroyInstanceFunction  m_destroyInstanceFunction = nullptr;  ///< Function to use to destroy an instance of this type.
+    ConstructInstanceFunction m_constructInstanceFunction = nullptr; ///< Function to use to construct an instance of this type in existing memory.
+    DestructInstanceFunction  m_destructInstanceFunction = nullptr;  ///< Function to use to destruct an instance of this type in place.
 };
 
 class ReflectedMember
@@ -245,12 +655,22 @@ public:
     ///
     inline bool isPointer() const { return m_isPointer; }
 
+    ///
+    /// Get the ordinal of this member within its type (the order in which it was reflected).
+    ///
+    /// @return Ordinal of this member.
+    ///
+    inline size_t ordinal() const { return m_ordinal; }
+
 private:
 
+    friend class ReflectionData;
+
     const std::string     m_name;       ///< Name of this variable.
     size_t                m_offset = 0;     ///< Offset (in bytes) from the start of the class for this variable.
     size_t                m_size = 0;       ///< Size of this variable (in bytes).
     bool                  m_isPointer = false;  ///< If true, this member variable is a pointer to an instance of some other type.
+    size_t                m_ordinal = 0;    ///< Ordinal of this member within its type. Assigned by ReflectionData::addMember().
     const ReflectionData *m_data = nullptr;       ///< Reflected data for this variable.
 };
 
@@ -286,19 +706,39 @@ public:
     /// @param size Size of the type in bytes.
     ///
     static void init(const std::string &name, size_t size)
+    {
+        ReflectionData &data = initUnregistered(name, size);
+        
+        registerReflectionData();
+        ReflectionDataManager::instance().addReflectedData(&data);
+    }
+
+    ///
+    /// Initialize this type without registering any members or adding it to the ReflectionDataManager. Used for
+    /// types which only ever appear as members, such as the standard containers (see ReflectionContainers.h).
+    ///
+    /// @param name Name of the type.
+    /// @param size Size of the type in bytes.
+    /// @return Reflection data of this type.
+    ///
+    static ReflectionData &initUnregistered(const std::string &name, size_t size)
     {
         ReflectionData &data = instance();
 
         ReflectionData::ReflectionDataCInfo info;
         info.name = name;
         info.size = size;
+        info.alignment = alignof(T);
+        info.isTriviallyCopyable = std::is_trivially_copyable<T>::value;
+        info.isTriviallyDestructible = std::is_trivially_destructible<T>::value;
         info.allocateFunction = std::bind(allocateInstance);
+        info.destroyFunction = destroyInstance;
+        info.constructFunction = constructInstance;
+        info.destructFunction = destructInstance;
 
         // Initialize this reflection data.
         data.init(info);
-        
-        registerReflectionData();
-        ReflectionDataManager::instance().addReflectedData(&data);
+        return data;
     }
 
     ///
@@ -324,6 +764,17 @@ public:
     {
         instance().declareParent(parent);
     }
+
+    ///
+    /// Add another name a member of this type can be found by.
+    ///
+    /// @param name Current name of the member.
+    /// @param alias Previous name of the member.
+    ///
+    static void addMemberAlias(const std::string &name, const std::string &alias)
+    {
+        instance().addMemberAlias(name, alias);
+    }
     
     ///
     /// Perform a null cast which is specific to this type.
@@ -349,6 +800,38 @@ public:
         T *instance = new T;
         return static_cast<void *>(instance);
     }
+
+    ///
+    /// Destroy an instance of this type created with allocateInstance().
+    ///
+    /// @param instance Instance to destroy.
+    ///
+    static void destroyInstance(void *instance)
+    {
+        delete static_cast<T *>(instance);
+    }
+
+    ///
+    /// Construct an instance of this type in existing memory.
+    ///
+    /// @param memory Suitably sized and aligned memory to construct the instance in.
+    /// @return The constructed instance.
+    ///
+    static void *constructInstance(void *memory)
+    {
+        T *instance = new (memory) T;
+        return static_cast<void *>(instance);
+    }
+
+    ///
+    /// Run the destructor of an instance created with constructInstance().
+    ///
+    /// @param instance Instance to destruct.
+    ///
+    static void destructInstance(void *instance)
+    {
+        static_cast<T *>(instance)->~T();
+    }
 };
 
 } // namespace carl
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "ReflectionDataManager.h"
 #include "ReflectionPrimitiveTypes.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <functional>
 
@@ -30,10 +31,17 @@ void ReflectionDataManager::addReflectedData(const ReflectionData *data)
 {
     assert(data != nullptr);
 
-    size_t hash = hashString(data->name());    
+    size_t hash = hashString(data->name());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
     assert(m_reflectedData.find(hash) == m_reflectedData.end());
     
     m_reflectedData[hash] = data;
+
+    // Types registered after freezing are made visible to readers by publishing a new table.
+    if (isFrozen()) {
+        publish();
+    }
 }
 
 const ReflectionData *ReflectionDataManager::reflectionData(const std::string &name)
@@ -44,16 +52,75 @@ const ReflectionData *ReflectionDataManager::reflectionData(const std::string &n
 
 const ReflectionData *ReflectionDataManager::reflectionData(size_t hashedName)
 {
-    ReflectionTable::const_iterator iter = m_reflectedData.find(hashedName);
-    if (iter != m_reflectedData.end()) {
+    // Published tables are never modified so no lock is needed to read them.
+    const ReflectionTable *frozenTable = m_frozenTable.load(std::memory_order_acquire);
+    if (frozenTable != nullptr) {
+        return find(*frozenTable, hashedName);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return find(m_reflectedData, hashedName);
+}
+
+const ReflectionData *ReflectionDataManager::find(const ReflectionTable &table, size_t hashedName)
+{
+    ReflectionTable::const_iterator iter = table.find(static_cast<ReflectionTable::key_type>(hashedName));
+    if (iter != table.end()) {
         return iter->second;
     }
     
     return nullptr;
 }
 
+void ReflectionDataManager::statistics(Statistics &statistics) const
+{
+    statistics.clear();
+
+#if CARL_INSTRUMENTATION
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &reflectedData : m_reflectedData) {
+        TypeStatistics typeStatistics;
+        reflectedData.second->counters().read(typeStatistics);
+        if (typeStatistics.objectsWritten || typeStatistics.objectsRead) {
+            typeStatistics.name = reflectedData.second->name();
+            statistics.push_back(typeStatistics);
+        }
+    }
+
+    // The most expensive types are the interesting ones.
+    std::sort(statistics.begin(), statistics.end(), [](const TypeStatistics &a, const TypeStatistics &b) {
+        return (a.serializeNanoseconds + a.deserializeNanoseconds) > (b.serializeNanoseconds + b.deserializeNanoseconds);
+    });
+#endif
+}
+
+void ReflectionDataManager::resetStatistics()
+{
+#if CARL_INSTRUMENTATION
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &reflectedData : m_reflectedData) {
+        reflectedData.second->counters().reset();
+    }
+#endif
+}
+
+void ReflectionDataManager::freeze()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!isFrozen()) {
+        publish();
+    }
+}
+
+void ReflectionDataManager::publish()
+{
+    m_publishedTables.push_back(std::make_unique<const ReflectionTable>(m_reflectedData));
+    m_frozenTable.store(m_publishedTables.back().get(), std::memory_order_release);
+}
+
 void ReflectionDataManager::allTypenames(Typenames &typenames) const
 {
+	std::lock_guard<std::mutex> lock(m_mutex);
 	assert(!m_reflectedData.empty());
 
 	typenames.resize(m_reflectedData.size());
@@ -11,7 +11,18 @@
 ///
 /// Hold all defitions of reflected types for later retrieval.
 ///
+/// Types are registered from static initializers and may be looked up from any thread.
+/// Until freeze() is called, registration and lookups are serialized with a mutex. After
+/// freeze(), lookups read an immutable table without taking any locks. Types registered
+/// after that point (e.g. from a plugin) are added to a copy of the table which is then
+/// published atomically, so readers never wait on a registration.
+///
+
+#include "Instrumentation.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -60,6 +71,33 @@ public:
     using Typenames = std::vector<std::string>;
     void allTypenames(Typenames &typenames) const;
 
+    ///
+    /// Get the instrumentation statistics of every type that has been serialized or deserialized. Statistics are
+    /// only collected when the library is built with CARL_INSTRUMENTATION, otherwise the list is left empty.
+    ///
+    /// @param statistics List of statistics to populate, sorted by total serialize and deserialize time (highest first).
+    ///
+    using Statistics = std::vector<TypeStatistics>;
+    void statistics(Statistics &statistics) const;
+
+    ///
+    /// Reset the instrumentation statistics of every type to zero.
+    ///
+    void resetStatistics();
+
+    ///
+    /// Publish the current set of types as an immutable table. After this call lookups no longer take a lock.
+    /// Calling this more than once has no effect.
+    ///
+    void freeze();
+
+    ///
+    /// Has freeze() been called?
+    ///
+    /// @return If true, lookups are lock-free.
+    ///
+    inline bool isFrozen() const { return m_frozenTable.load(std::memory_order_acquire) != nullptr; }
+
 private:
     // This class is a singleton and cannot be copied.
     ReflectionDataManager() = default;
@@ -68,7 +106,22 @@ private:
     ReflectionDataManager &operator=(const ReflectionDataManager &other) = delete;
 
     using ReflectionTable = std::unordered_map<uint32_t, const ReflectionData *>;
+
+    ///
+    /// Find a type in a table.
+    ///
+    static const ReflectionData *find(const ReflectionTable &table, size_t hashedName);
+
+    ///
+    /// Copy m_reflectedData into a new immutable table and make it the one used by readers. m_mutex must be held.
+    ///
+    void publish();
+
     ReflectionTable m_reflectedData; ///< All reflected objects stored by a string key. Use Qi::StringHash() to generate a key for to classname to lookup.
+    mutable std::mutex m_mutex;      ///< Guards m_reflectedData and m_publishedTables.
+
+    std::atomic<const ReflectionTable *> m_frozenTable { nullptr }; ///< Most recently published table, nullptr until freeze() is called.
+    std::vector<std::unique_ptr<const ReflectionTable>> m_publishedTables; ///< Every published table. Older tables are kept alive as readers may still be using them.
 };
 
 } // namespace carl
\ No newline at end of file
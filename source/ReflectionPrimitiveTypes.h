@@ -14,10 +14,13 @@
 
 #include "../carl.h"
 #include "ReflectedVariable.h"
+#include "BinaryStream.h"
+#include "TextStream.h"
 
 #include <assert.h>
 #include <ostream>
 #include <istream>
+#include <string_view>
 
 ///
 /// Macro to declare the reflection data for primitive (POD) types. All reflected primitive types are declared in this file.
@@ -28,6 +31,8 @@
     { \
         carl::ReflectionDataCreator<carl::QualifierRemover<T>::type>::instance().setSerializeFunction(serializePrimitiveValue<carl::QualifierRemover<T>::type>); \
 		carl::ReflectionDataCreator<carl::QualifierRemover<T>::type>::instance().setDeserializeFunction(deserializePrimitiveValue<carl::QualifierRemover<T>::type>); \
+        carl::ReflectionDataCreator<carl::QualifierRemover<T>::type>::instance().setBinarySerializeFunction(serializePrimitiveValueBinary<carl::QualifierRemover<T>::type>); \
+        carl::ReflectionDataCreator<carl::QualifierRemover<T>::type>::instance().setBinaryDeserializeFunction(deserializePrimitiveValueBinary<carl::QualifierRemover<T>::type>); \
     }
 
 namespace carl {
@@ -35,39 +40,97 @@ namespace carl {
 template<class T>
 void serializePrimitiveValue(const ReflectedVariable *variable, std::ostream &stream)
 {
-	stream << variable->value<T>() << std::endl;
+	text::writeValue(stream, variable->value<T>(), '\n');
 }
 
 template<class T>
 void deserializePrimitiveValue(ReflectedVariable *variable, std::istream &stream)
 {
-	stream >> variable->value<T>();
+	text::readValue(stream, variable->value<T>());
+}
+
+template<class T>
+void serializePrimitiveValueBinary(const ReflectedVariable *variable, BinaryWriter &writer)
+{
+	writer.write<T>(variable->value<T>());
+}
+
+template<class T>
+void deserializePrimitiveValueBinary(ReflectedVariable *variable, BinaryReader &reader)
+{
+	variable->value<T>() = reader.read<T>();
 }
 
 /////// Specializations for serializing string types (have to be able to handle multiple words).
 template<>
 void serializePrimitiveValue<std::string>(const ReflectedVariable *variable, std::ostream &stream)
 {
-	std::string string = variable->value<std::string>();
+	const std::string &string = variable->value<std::string>();
 
-	stream << string.length() << " " << string << std::endl;
+	text::writeValue(stream, string.length(), ' ');
+	stream.write(string.data(), string.length());
+	stream.put('\n');
 }
 
 template<>
 void deserializePrimitiveValue<std::string>(ReflectedVariable *variable, std::istream &stream)
 {
 	size_t stringLength = 0;
-	stream >> stringLength;
+	text::readValue(stream, stringLength);
 
-	assert(stringLength > 0);
+	// Skip the space inserted by the serialization function.
+	stream.get();
 
-	// seek ahead one character to avoid reading the space inserted by the serialization function.
-	stream.seekg(1, std::ios_base::cur);
+	std::string &string = variable->value<std::string>();
+	string.resize(stringLength);
+	stream.read(string.data(), stringLength);
+}
 
-	char tmpArray[1024];
-	stream.read(tmpArray, stringLength);
-	std::string tmp(tmpArray, stringLength);
-	variable->value<std::string>() = tmp;
+template<>
+void serializePrimitiveValueBinary<std::string>(const ReflectedVariable *variable, BinaryWriter &writer)
+{
+	writer.writeString(variable->value<std::string>());
+}
+
+template<>
+void deserializePrimitiveValueBinary<std::string>(ReflectedVariable *variable, BinaryReader &reader)
+{
+	reader.readString(variable->value<std::string>());
+}
+////////
+
+/////// Specializations for string views. Views are written exactly like strings but do not own their characters, so
+/////// they either point into memory that outlives the deserialized objects (see MappedSnapshot) or at characters kept
+/////// by the allocator (see PointerTable::keepCharacters()).
+template<>
+void serializePrimitiveValue<std::string_view>(const ReflectedVariable *variable, std::ostream &stream)
+{
+	std::string_view view = variable->value<std::string_view>();
+
+	text::writeValue(stream, view.length(), ' ');
+	stream.write(view.data(), view.length());
+	stream.put('\n');
+}
+
+template<>
+void deserializePrimitiveValue<std::string_view>(ReflectedVariable * /*variable*/, std::istream &stream)
+{
+	// Views are read by ReflectionData::deserialize() which has the pointer table to keep their characters in.
+	stream.setstate(std::ios::failbit);
+}
+
+template<>
+void serializePrimitiveValueBinary<std::string_view>(const ReflectedVariable *variable, BinaryWriter &writer)
+{
+	writer.writeString(variable->value<std::string_view>());
+}
+
+template<>
+void deserializePrimitiveValueBinary<std::string_view>(ReflectedVariable *variable, BinaryReader &reader)
+{
+	// Only valid when the reader's memory outlives the variable, records copy the characters otherwise
+	// (see ReflectionData::deserializeOpBinary()).
+	variable->value<std::string_view>() = reader.readStringView();
 }
 ////////
 
@@ -84,5 +147,6 @@ CARL_DECLARE_REFLECTION_PRIMITIVE_TYPE(uint64_t);
 CARL_DECLARE_REFLECTION_PRIMITIVE_TYPE(long);
 CARL_DECLARE_REFLECTION_PRIMITIVE_TYPE(long long);
 CARL_DECLARE_REFLECTION_PRIMITIVE_TYPE(std::string);
+CARL_DECLARE_REFLECTION_PRIMITIVE_TYPE(std::string_view);
 
 } // namespace carl.
\ No newline at end of file
@@ -0,0 +1,38 @@
+//
+//  SerializationFormat.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Formats that a reflected variable (and its pointer table) can be serialized to.
+///
+
+#include <cstddef>
+#include <functional>
+
+namespace carl {
+
+enum class SerializationFormat
+{
+    Text,    ///< Human readable, tab-indented format which names every type and member.
+    Binary,  ///< Compact format made of length-prefixed records, integer type IDs and fixed-width primitives.
+    Columnar ///< Binary format which groups records by type and stores each member of a group contiguously (see BinaryStream.h).
+};
+
+///
+/// Function receiving streamed binary data (see ReflectedVariable::serializeStreaming()) one chunk at a time.
+/// The data is only valid for the duration of the call.
+///
+using StreamSink = std::function<void(const char *data, size_t size)>;
+
+///
+/// Default size of the chunks passed to a StreamSink (in bytes).
+///
+constexpr size_t kDefaultStreamChunkSize = 64 * 1024;
+
+} // namespace carl
@@ -0,0 +1,66 @@
+//
+//  SerializationPlan.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// A flattened description of how an instance of a reflected type is written to (and read from)
+/// the binary format. Parent types and nested (non-pointer) objects are inlined so that an
+/// instance can be processed with a single linear pass over the operations.
+///
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace carl {
+
+// Forward declarations.
+class ReflectionData;
+
+struct SerializationPlan
+{
+    ///
+    /// A single operation on the payload of a record.
+    ///
+    struct Op
+    {
+        enum class Kind : uint8_t
+        {
+            Bytes,      ///< 'count' bytes at 'offset' are copied as-is.
+            String,     ///< 'count' consecutive std::string objects at 'offset'.
+            StringView, ///< 'count' consecutive std::string_view objects at 'offset'.
+            Pointer,    ///< A pointer to an instance of 'data' at 'offset', written as a table index.
+            Custom,     ///< 'count' consecutive instances of 'data' at 'offset' which use the type's own binary functions.
+            Container   ///< 'count' consecutive containers of type 'data' at 'offset' (see ReflectionContainers.h).
+        };
+
+        Kind                  kind   = Kind::Bytes;
+        size_t                offset = 0;       ///< Offset (in bytes) from the start of the object being processed.
+        size_t                count  = 0;       ///< Number of bytes (Bytes) or elements (String, StringView, Custom) to process.
+        const ReflectionData *data   = nullptr; ///< Type the operation works on (Pointer, Custom and Container only).
+        size_t                repeat = 1;       ///< Number of times the operation applies, 'stride' bytes apart (columnar plans only).
+        size_t                stride = 0;       ///< Distance (in bytes) between repetitions.
+    };
+
+    ///
+    /// A nested object which has its own entry in the pointer table. The table indices of nested objects
+    /// are written to the record in the order they appear here (depth-first).
+    ///
+    struct Object
+    {
+        size_t                offset = 0;       ///< Offset (in bytes) from the start of the object being processed.
+        const ReflectionData *data   = nullptr; ///< Type of the nested object.
+    };
+
+    std::vector<Op>     ops;                     ///< Payload operations in stream order.
+    std::vector<Object> objects;                 ///< Nested objects in stream order.
+    bool                isBlockCopyable = false; ///< If true, 'ops' is a single Bytes operation covering the entire type.
+};
+
+} // namespace carl
@@ -0,0 +1,437 @@
+//
+//  StreamScanner.cpp
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#include "StreamScanner.h"
+#include "ReflectionData.h"
+#include "ReflectionContainers.h"
+#include "BinaryStream.h"
+
+#include <assert.h>
+
+namespace carl {
+
+namespace {
+
+///
+/// Hands out the bytes of data held in memory.
+///
+class MemorySource
+{
+public:
+	MemorySource(const char *data, size_t size) : m_reader(data, size) {}
+
+	inline BinaryReader next(size_t size) { return m_reader.subReader(size); }
+
+private:
+	BinaryReader m_reader;
+};
+
+///
+/// Hands out the bytes of a stream. Each call reuses the same buffer, so a reader is only valid until the next call.
+///
+class StreamSource
+{
+public:
+	StreamSource(std::istream &stream, std::vector<char> &buffer) : m_stream(stream), m_buffer(buffer) {}
+
+	inline BinaryReader next(size_t size)
+	{
+		m_buffer.resize(size);
+		m_stream.read(m_buffer.data(), size);
+		assert(m_stream);
+		return BinaryReader(m_buffer.data(), size);
+	}
+
+private:
+	std::istream      &m_stream;
+	std::vector<char> &m_buffer;
+};
+
+} // namespace
+
+StreamScanner::~StreamScanner()
+{
+	for (auto &scratch : m_scratch) {
+		scratch.first->destroyInstance(scratch.second);
+	}
+}
+
+void StreamScanner::scan(const char *data, size_t size, StreamVisitor &visitor)
+{
+	MemorySource source(data, size);
+	scanSource(source, visitor);
+}
+
+void StreamScanner::scan(std::istream &stream, StreamVisitor &visitor)
+{
+	StreamSource source(stream, m_buffer);
+	scanSource(source, visitor);
+}
+
+template<class Source>
+void StreamScanner::scanSource(Source &source, StreamVisitor &visitor)
+{
+	m_schema = StreamSchema();
+	m_nested.clear();
+
+	BinaryReader header = source.next(sizeof(binary::kMagic) + 2 * sizeof(uint32_t));
+	char magic[sizeof(binary::kMagic)];
+	header.read(magic, sizeof(magic));
+	uint32_t version = header.read<uint32_t>();
+	uint32_t byteOrder = header.read<uint32_t>();
+	assert(byteOrder == binary::kByteOrder);
+	(void)byteOrder;
+
+	if (memcmp(magic, binary::kStreamMagic, sizeof(magic)) != 0) {
+		assert(memcmp(magic, binary::kMagic, sizeof(magic)) == 0);
+		assert(version == binary::kVersion);
+
+		// The table size isn't needed, nothing is placed in a table.
+		BinaryReader counts = source.next(2 * sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t));
+		counts.skip(sizeof(uint64_t));
+		uint64_t recordCount = counts.read<uint64_t>();
+		uint32_t typeCount = counts.read<uint32_t>();
+		uint64_t schemaSize = counts.read<uint64_t>();
+
+		BinaryReader types = source.next(schemaSize);
+		readTypes(types, typeCount);
+
+		for (uint64_t ii = 0; ii < recordCount; ++ii) {
+			uint64_t recordSize = source.next(sizeof(uint64_t)).template read<uint64_t>();
+			assert(recordSize >= binary::kRecordHeaderSize);
+			BinaryReader record = source.next(recordSize);
+			scanRecord(record, visitor);
+		}
+		return;
+	}
+
+	assert(version == binary::kStreamVersion);
+	(void)version;
+	for (;;) {
+		uint8_t block = source.next(sizeof(uint8_t)).template read<uint8_t>();
+		switch (block) {
+			case binary::kStreamTypes:
+			{
+				BinaryReader sizes = source.next(sizeof(uint32_t) + sizeof(uint64_t));
+				uint32_t typeCount = sizes.read<uint32_t>();
+				uint64_t typesSize = sizes.read<uint64_t>();
+				BinaryReader types = source.next(typesSize);
+				readTypes(types, typeCount);
+				break;
+			}
+
+			case binary::kStreamRecord:
+			{
+				BinaryReader sizes = source.next(2 * sizeof(uint64_t));
+				sizes.skip(sizeof(uint64_t));
+				uint64_t recordSize = sizes.read<uint64_t>();
+				assert(recordSize >= binary::kRecordHeaderSize);
+				BinaryReader record = source.next(recordSize);
+				scanRecord(record, visitor);
+				break;
+			}
+
+			case binary::kStreamEnd:
+				source.next(2 * sizeof(uint64_t));
+				return;
+
+			default:
+				assert(false && "Unknown block in streamed binary data");
+				return;
+		}
+	}
+}
+
+void StreamScanner::readTypes(BinaryReader &reader, uint32_t typeCount)
+{
+	m_schema.read(reader, typeCount);
+}
+
+void StreamScanner::scanRecord(BinaryReader &reader, StreamVisitor &visitor)
+{
+	uint32_t typeId = reader.read<uint32_t>();
+	assert(typeId < m_schema.size());
+	uint8_t flags = reader.read<uint8_t>();
+	uint8_t padding = reader.read<uint8_t>();
+
+	StreamRecord record;
+	record.index = reader.read<uint64_t>();
+	record.type = streamType(typeId);
+	record.isNull = ((flags & binary::kRecordNull) != 0);
+	uint32_t subobjectCount = reader.read<uint32_t>();
+
+	// Records which aren't wanted are passed over by their length.
+	if (!visitor.beginRecord(record)) {
+		return;
+	}
+
+	if (!record.isNull) {
+		BinaryRecordReader contents;
+		contents.subobjects = reader.subReader(subobjectCount * sizeof(uint64_t));
+		reader.skip(padding);
+		contents.payload = reader;
+
+		if (m_schema.m_types[typeId].kind == StreamSchema::Kind::Class) {
+			scanObject(typeId, contents, &visitor);
+		} else {
+			size_t cursor = m_nested.size();
+			scanValue(typeId, false, contents, &visitor, cursor);
+		}
+		assert(contents.payload.atEnd() && contents.subobjects.atEnd());
+	}
+
+	visitor.endRecord(record);
+}
+
+void StreamScanner::scanObject(uint32_t id, BinaryRecordReader &record, StreamVisitor *visitor)
+{
+	// The indices of nested objects are listed ahead of the payload, they're handed out as the objects are reached.
+	size_t first = m_nested.size();
+	gatherNested(id, record);
+
+	size_t cursor = first;
+	const StreamSchema::RemapEntry *entry = m_schema.m_types[id].remap.data();
+	scanMembers(id, entry, record, visitor, cursor);
+	assert(cursor == m_nested.size());
+	m_nested.resize(first);
+}
+
+void StreamScanner::scanMembers(uint32_t id, const StreamSchema::RemapEntry *&entry, BinaryRecordReader &record, StreamVisitor *visitor, size_t &cursor)
+{
+	// Members of parents come first in the stream, as they do in the remap table.
+	const StreamSchema::Type &type = m_schema.m_types[id];
+	if (type.parent != StreamSchema::kNoType) {
+		scanMembers(type.parent, entry, record, visitor, cursor);
+	}
+
+	for (auto &member : type.members) {
+		StreamMember info;
+		info.name = member.name;
+		info.type = streamType(member.type);
+		info.local = entry->target;
+		info.count = member.count;
+		info.isPointer = member.isPointer;
+		++entry;
+
+		// Skipped members are still walked to get past them.
+		StreamVisitor *memberVisitor = (visitor != nullptr && visitor->beginMember(info)) ? visitor : nullptr;
+		if (member.isPointer || member.count == 1) {
+			scanValue(member.type, member.isPointer, record, memberVisitor, cursor);
+		} else if (isRun(member.type)) {
+			scanRun(member.type, member.count, record, memberVisitor);
+		} else {
+			for (uint64_t ii = 0; ii < member.count; ++ii) {
+				if (memberVisitor != nullptr) {
+					memberVisitor->beginElement(ii);
+				}
+				scanValue(member.type, false, record, memberVisitor, cursor);
+				if (memberVisitor != nullptr) {
+					memberVisitor->endElement(ii);
+				}
+			}
+		}
+
+		if (memberVisitor != nullptr) {
+			memberVisitor->endMember(info);
+		}
+	}
+}
+
+void StreamScanner::scanValue(uint32_t id, bool isPointer, BinaryRecordReader &record, StreamVisitor *visitor, size_t &cursor)
+{
+	const StreamSchema::Type &type = m_schema.m_types[id];
+	StreamValue value;
+	value.type = streamType(id);
+
+	if (isPointer) {
+		value.kind = StreamValue::Kind::Pointer;
+		value.pointerIndex = record.payload.read<uint64_t>();
+		if (visitor != nullptr) {
+			visitor->value(value);
+		}
+		return;
+	}
+
+	switch (type.kind) {
+		case StreamSchema::Kind::Primitive:
+			switch (type.encoding) {
+				case SerializationPlan::Op::Kind::String:
+				case SerializationPlan::Op::Kind::StringView:
+					value.kind = StreamValue::Kind::String;
+					value.size = static_cast<size_t>(record.payload.read<uint64_t>());
+					value.data = record.payload.position();
+					record.payload.skip(value.size);
+					break;
+
+				case SerializationPlan::Op::Kind::Custom:
+				{
+					// Only the type itself knows how much it wrote.
+					assert(type.local && "Members with a custom encoding must still be registered to be scanned");
+					void *instance = scratchInstance(type.local);
+					value.kind = StreamValue::Kind::Custom;
+					value.data = record.payload.position();
+					type.local->deserializeElementBinary(instance, false, record, m_table);
+					value.size = static_cast<size_t>(record.payload.position() - value.data);
+					value.instance = instance;
+					break;
+				}
+
+				default:
+					value.kind = StreamValue::Kind::Bytes;
+					value.data = record.payload.position();
+					value.size = static_cast<size_t>(type.size);
+					record.payload.skip(value.size);
+					break;
+			}
+
+			if (visitor != nullptr) {
+				visitor->value(value);
+			}
+			break;
+
+		case StreamSchema::Kind::Class:
+		{
+			uint64_t index = kNoStreamIndex;
+			if (!type.members.empty()) {
+				assert(cursor < m_nested.size());
+				index = m_nested[cursor++];
+			}
+
+			if (visitor != nullptr) {
+				visitor->beginObject(value.type, index);
+			}
+			const StreamSchema::RemapEntry *entry = type.remap.data();
+			scanMembers(id, entry, record, visitor, cursor);
+			if (visitor != nullptr) {
+				visitor->endObject(value.type);
+			}
+			break;
+		}
+
+		case StreamSchema::Kind::Container:
+			scanContainer(id, record, visitor, cursor);
+			break;
+	}
+}
+
+void StreamScanner::scanElement(uint32_t id, bool isPointer, BinaryRecordReader &record, StreamVisitor *visitor, size_t &cursor)
+{
+	const StreamSchema::Type &type = m_schema.m_types[id];
+	if (isPointer || type.kind != StreamSchema::Kind::Class) {
+		scanValue(id, isPointer, record, visitor, cursor);
+		return;
+	}
+
+	// Elements which are objects have their own table entry, followed by those of their nested objects.
+	uint64_t index = kNoStreamIndex;
+	if (!type.members.empty()) {
+		index = record.subobjects.read<uint64_t>();
+	}
+
+	StreamType elementType = streamType(id);
+	if (visitor != nullptr) {
+		visitor->beginObject(elementType, index);
+	}
+	scanObject(id, record, visitor);
+	if (visitor != nullptr) {
+		visitor->endObject(elementType);
+	}
+}
+
+void StreamScanner::scanContainer(uint32_t id, BinaryRecordReader &record, StreamVisitor *visitor, size_t &cursor)
+{
+	// Block copied elements are laid out exactly as if they had been written one by one.
+	const StreamSchema::Type &type = m_schema.m_types[id];
+	uint64_t count = record.payload.read<uint64_t>();
+	bool isMap = (type.containerKind == static_cast<uint8_t>(ContainerInfo::Kind::Map));
+
+	StreamType containerType = streamType(id);
+	if (visitor != nullptr) {
+		visitor->beginContainer(containerType, count);
+	}
+
+	if (!isMap && !type.elementIsPointer && isRun(type.element)) {
+		scanRun(type.element, count, record, visitor);
+		count = 0;
+	}
+
+	for (uint64_t ii = 0; ii < count; ++ii) {
+		if (visitor != nullptr) {
+			visitor->beginElement(ii);
+		}
+		if (isMap) {
+			scanElement(type.key, false, record, visitor, cursor);
+		}
+		scanElement(type.element, type.elementIsPointer, record, visitor, cursor);
+		if (visitor != nullptr) {
+			visitor->endElement(ii);
+		}
+	}
+
+	if (visitor != nullptr) {
+		visitor->endContainer(containerType);
+	}
+}
+
+bool StreamScanner::isRun(uint32_t id) const
+{
+	const StreamSchema::Type &type = m_schema.m_types[id];
+	return (type.kind == StreamSchema::Kind::Primitive && type.encoding == SerializationPlan::Op::Kind::Bytes);
+}
+
+void StreamScanner::scanRun(uint32_t id, uint64_t count, BinaryRecordReader &record, StreamVisitor *visitor)
+{
+	StreamValue value;
+	value.kind = StreamValue::Kind::Bytes;
+	value.type = streamType(id);
+	value.count = count;
+	value.size = static_cast<size_t>(count * m_schema.m_types[id].size);
+	value.data = record.payload.position();
+	record.payload.skip(value.size);
+
+	if (visitor != nullptr && count > 0) {
+		visitor->value(value);
+	}
+}
+
+void StreamScanner::gatherNested(uint32_t id, BinaryRecordReader &record)
+{
+	// Same order as StreamSchema::registerNested().
+	for (auto &entry : m_schema.m_types[id].remap) {
+		const StreamSchema::Type &memberType = m_schema.m_types[entry.type];
+		if (entry.isPointer || memberType.kind != StreamSchema::Kind::Class) {
+			continue;
+		}
+
+		for (uint64_t ii = 0; ii < entry.count; ++ii) {
+			if (!memberType.members.empty()) {
+				m_nested.push_back(record.subobjects.read<uint64_t>());
+			}
+			gatherNested(entry.type, record);
+		}
+	}
+}
+
+StreamType StreamScanner::streamType(uint32_t id) const
+{
+	StreamType type;
+	type.name = m_schema.m_types[id].name;
+	type.local = m_schema.m_types[id].local;
+	return type;
+}
+
+void *StreamScanner::scratchInstance(const ReflectionData *type)
+{
+	void *&instance = m_scratch[type];
+	if (instance == nullptr) {
+		instance = type->allocateInstance();
+	}
+	return instance;
+}
+
+} // namespace carl
@@ -0,0 +1,121 @@
+//
+//  StreamScanner.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Event-driven reader for binary streams (see StreamVisitor.h). Streams are walked with the layout
+/// they carry (see StreamSchema.h) and no objects are created, so a snapshot can be inspected (counting
+/// instances, pulling out a single member) without the cost of deserializing it. Both the regular and
+/// the streamed layout (see BinaryStream.h) can be scanned, as can streams whose types have since
+/// changed or are no longer registered.
+///
+/// Memory is only allocated to read the layout of each stream. Record buffers and the other scratch
+/// space are kept between scans, so a scanner reused for many streams stops allocating once it has
+/// seen the largest record. Types with their own binary functions are the exception: one instance of
+/// each is created the first time it is found so that it can decode (and measure) its values.
+///
+
+#include "StreamVisitor.h"
+#include "StreamSchema.h"
+#include "PointerTable.h"
+
+#include <istream>
+#include <unordered_map>
+#include <vector>
+
+namespace carl {
+
+class StreamScanner
+{
+public:
+    StreamScanner() = default;
+    ~StreamScanner();
+
+    // This scanner is not copyable.
+    StreamScanner(const StreamScanner &other) = delete;
+    StreamScanner &operator=(const StreamScanner &other) = delete;
+
+    ///
+    /// Scan binary data held in memory.
+    ///
+    /// @param data Start of the serialized data.
+    /// @param size Size of the serialized data (in bytes).
+    /// @param visitor Visitor to report the contents of the stream to.
+    ///
+    void scan(const char *data, size_t size, StreamVisitor &visitor);
+
+    ///
+    /// Scan binary data from a stream, one record at a time.
+    ///
+    /// @param stream Stream to read from.
+    /// @param visitor Visitor to report the contents of the stream to.
+    ///
+    void scan(std::istream &stream, StreamVisitor &visitor);
+
+private:
+
+    ///
+    /// Scan every part of a stream read through 'source', which provides BinaryReaders over the next bytes.
+    ///
+    template<class Source>
+    void scanSource(Source &source, StreamVisitor &visitor);
+
+    ///
+    /// Read the types of the next part of the stream's schema.
+    ///
+    void readTypes(BinaryReader &reader, uint32_t typeCount);
+
+    ///
+    /// Walk a single record (everything after its size).
+    ///
+    void scanRecord(BinaryReader &reader, StreamVisitor &visitor);
+
+    ///
+    /// Walks of the parts of a record. 'visitor' is nullptr while the contents of a skipped member are passed
+    /// over. 'cursor' is the position of the next nested object index in m_nested.
+    ///
+    void scanObject(uint32_t id, BinaryRecordReader &record, StreamVisitor *visitor);
+    void scanMembers(uint32_t id, const StreamSchema::RemapEntry *&entry, BinaryRecordReader &record, StreamVisitor *visitor, size_t &cursor);
+    void scanValue(uint32_t id, bool isPointer, BinaryRecordReader &record, StreamVisitor *visitor, size_t &cursor);
+    void scanElement(uint32_t id, bool isPointer, BinaryRecordReader &record, StreamVisitor *visitor, size_t &cursor);
+    void scanContainer(uint32_t id, BinaryRecordReader &record, StreamVisitor *visitor, size_t &cursor);
+
+    ///
+    /// Determine if consecutive values of a type are reported as a single run (see StreamValue::count).
+    ///
+    bool isRun(uint32_t id) const;
+
+    ///
+    /// Report a run of trivially copyable values.
+    ///
+    void scanRun(uint32_t id, uint64_t count, BinaryRecordReader &record, StreamVisitor *visitor);
+
+    ///
+    /// Gather the table indices of the nested objects of an object, in the order they're listed in the record.
+    ///
+    void gatherNested(uint32_t id, BinaryRecordReader &record);
+
+    ///
+    /// Describe a type of the stream.
+    ///
+    StreamType streamType(uint32_t id) const;
+
+    ///
+    /// Get the scratch instance used to decode values of a type with its own binary functions.
+    ///
+    void *scratchInstance(const ReflectionData *type);
+
+    StreamSchema                                      m_schema;  ///< Layout of the stream being scanned.
+    std::vector<char>                                 m_buffer;  ///< Record being scanned (streams only).
+    std::vector<uint64_t>                             m_nested;  ///< Table indices of the nested objects of the objects being scanned.
+    std::unordered_map<const ReflectionData *, void *> m_scratch; ///< Instance per type with its own binary functions.
+    PointerTable                                      m_table;   ///< Empty table handed to the binary functions of those types.
+};
+
+} // namespace carl
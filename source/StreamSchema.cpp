@@ -0,0 +1,596 @@
+//
+//  StreamSchema.cpp
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#include "StreamSchema.h"
+#include "ReflectionData.h"
+#include "ReflectionDataManager.h"
+#include "ReflectionContainers.h"
+#include "ReflectionUtilities.h"
+#include "ReflectedVariable.h"
+#include "PointerTable.h"
+#include "BinaryStream.h"
+
+#include <assert.h>
+
+namespace carl {
+
+namespace {
+
+void writeName(BinaryWriter &writer, const std::string &name)
+{
+	writer.write<uint32_t>(static_cast<uint32_t>(name.length()));
+	writer.write(name.data(), name.length());
+}
+
+std::string readName(BinaryReader &reader)
+{
+	uint32_t length = reader.read<uint32_t>();
+	assert(reader.remaining() >= length);
+	std::string name(reader.position(), length);
+	reader.skip(length);
+	return name;
+}
+
+///
+/// Primitives are the types which write themselves rather than through members.
+///
+bool isPrimitive(const ReflectionData *type)
+{
+	return (!type->isContainer() && !type->hasDataMembers() && !type->hasParent() && !type->plan().ops.empty());
+}
+
+///
+/// Number of elements a member is written as.
+///
+uint64_t elementCount(const ReflectedMember *member)
+{
+	return member->isPointer() ? 1 : (member->size() / member->reflectionData()->size());
+}
+
+///
+/// Find a member of a type, or of one of its parents, by name or alias.
+///
+const ReflectedMember *findMember(const ReflectionData *type, const std::string &name)
+{
+	for (; type != nullptr; type = type->parent()) {
+		const ReflectedMember *member = type->member(name);
+		if (member != nullptr) {
+			return member;
+		}
+	}
+
+	return nullptr;
+}
+
+} // namespace
+
+uint32_t StreamSchema::add(const ReflectionData *type)
+{
+	auto iter = m_ids.find(type);
+	if (iter != m_ids.end()) {
+		return iter->second;
+	}
+
+	// The id is taken before the parts of the type are added so that types which point to themselves terminate.
+	uint32_t id = static_cast<uint32_t>(m_types.size());
+	m_ids[type] = id;
+	m_types.emplace_back();
+
+	Type entry;
+	entry.name = type->name();
+	entry.size = type->size();
+	if (type->isContainer()) {
+		const ContainerInfo &info = *type->container();
+		entry.kind = Kind::Container;
+		entry.containerKind = static_cast<uint8_t>(info.kind);
+		entry.element = add(info.element);
+		entry.key = (info.key != nullptr) ? add(info.key) : kNoType;
+		entry.elementIsPointer = info.elementIsPointer;
+	} else if (isPrimitive(type)) {
+		entry.kind = Kind::Primitive;
+		entry.encoding = type->plan().ops.front().kind;
+	} else {
+		entry.kind = Kind::Class;
+		entry.parent = type->hasParent() ? add(type->parent()) : kNoType;
+		for (auto &member : type->members()) {
+			Member streamMember;
+			streamMember.name = member->name();
+			streamMember.type = add(member->reflectionData());
+			streamMember.count = elementCount(member);
+			streamMember.isPointer = member->isPointer();
+			entry.members.push_back(streamMember);
+		}
+	}
+
+	m_types[id] = std::move(entry);
+	return id;
+}
+
+void StreamSchema::write(BinaryWriter &writer, size_t firstId) const
+{
+	for (size_t id = firstId; id < m_types.size(); ++id) {
+		const Type &type = m_types[id];
+		writeName(writer, type.name);
+		writer.write<uint8_t>(static_cast<uint8_t>(type.kind));
+		writer.write<uint64_t>(type.size);
+
+		switch (type.kind) {
+			case Kind::Primitive:
+				writer.write<uint8_t>(static_cast<uint8_t>(type.encoding));
+				break;
+
+			case Kind::Class:
+				writer.write<uint32_t>(type.parent);
+				writer.write<uint32_t>(static_cast<uint32_t>(type.members.size()));
+				for (auto &member : type.members) {
+					writeName(writer, member.name);
+					writer.write<uint32_t>(member.type);
+					writer.write<uint64_t>(member.count);
+					writer.write<uint8_t>(member.isPointer ? 1 : 0);
+				}
+				break;
+
+			case Kind::Container:
+				writer.write<uint8_t>(type.containerKind);
+				writer.write<uint32_t>(type.element);
+				writer.write<uint32_t>(type.key);
+				writer.write<uint8_t>(type.elementIsPointer ? 1 : 0);
+				break;
+		}
+	}
+}
+
+void StreamSchema::read(BinaryReader &reader, uint32_t typeCount)
+{
+	// Types of earlier parts never refer to those which follow, so only the new types need matching.
+	uint32_t firstId = static_cast<uint32_t>(m_types.size());
+	uint32_t endId = firstId + typeCount;
+	m_types.resize(endId);
+	for (uint32_t id = firstId; id < endId; ++id) {
+		Type &type = m_types[id];
+		type.name = readName(reader);
+		type.kind = static_cast<Kind>(reader.read<uint8_t>());
+		type.size = reader.read<uint64_t>();
+
+		switch (type.kind) {
+			case Kind::Primitive:
+				type.encoding = static_cast<SerializationPlan::Op::Kind>(reader.read<uint8_t>());
+				break;
+
+			case Kind::Class:
+				type.parent = reader.read<uint32_t>();
+				type.members.resize(reader.read<uint32_t>());
+				for (auto &member : type.members) {
+					member.name = readName(reader);
+					member.type = reader.read<uint32_t>();
+					assert(member.type < endId);
+					member.count = reader.read<uint64_t>();
+					member.isPointer = (reader.read<uint8_t>() != 0);
+				}
+				break;
+
+			case Kind::Container:
+				type.containerKind = reader.read<uint8_t>();
+				type.element = reader.read<uint32_t>();
+				type.key = reader.read<uint32_t>();
+				type.elementIsPointer = (reader.read<uint8_t>() != 0);
+				assert(type.element < endId);
+				break;
+
+			default:
+				assert(false && "Unknown type kind in binary stream");
+				break;
+		}
+	}
+	assert(reader.atEnd());
+
+	// Containers aren't registered by name, they are matched through the members holding them (see buildRemap()).
+	ReflectionDataManager &manager = ReflectionDataManager::instance();
+	for (uint32_t id = firstId; id < endId; ++id) {
+		Type &type = m_types[id];
+		if (type.kind != Kind::Container) {
+			type.local = manager.reflectionData(type.name);
+			if (!compatible(id, type.local)) {
+				type.local = nullptr;
+			}
+		}
+	}
+
+	// Classes are first compared member by member assuming the classes they contain match, then any class which
+	// contains a class that doesn't match is knocked out until nothing changes. This handles classes which contain
+	// themselves through containers.
+	std::vector<std::vector<uint32_t>> dependencies(endId);
+	for (uint32_t id = firstId; id < endId; ++id) {
+		Type &type = m_types[id];
+		if (type.local != nullptr) {
+			if (type.kind == Kind::Class) {
+				type.identical = matchesClass(id, dependencies[id]);
+			} else if (type.kind == Kind::Primitive) {
+				type.identical = true;
+			}
+		}
+	}
+
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (uint32_t id = firstId; id < endId; ++id) {
+			if (m_types[id].identical) {
+				for (uint32_t dependency : dependencies[id]) {
+					if (!m_types[dependency].identical) {
+						m_types[id].identical = false;
+						changed = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	for (uint32_t id = firstId; id < endId; ++id) {
+		if (m_types[id].kind != Kind::Container) {
+			m_identical = (m_identical && m_types[id].identical);
+		}
+	}
+
+	for (uint32_t id = firstId; id < endId; ++id) {
+		if (m_types[id].kind == Kind::Class) {
+			buildRemap(id);
+		}
+	}
+}
+
+bool StreamSchema::matches(uint32_t id, const ReflectionData *local, std::vector<uint32_t> &classes) const
+{
+	const Type &type = m_types[id];
+	switch (type.kind) {
+		case Kind::Primitive:
+			return compatible(id, local);
+
+		case Kind::Class:
+			// Classes are compared on their own (see matchesClass()), this one only has to be identical as well.
+			if (!compatible(id, local)) {
+				return false;
+			}
+			classes.push_back(id);
+			return true;
+
+		case Kind::Container:
+		{
+			if (!compatible(id, local) || local->size() != type.size) {
+				return false;
+			}
+
+			const ContainerInfo &info = *local->container();
+			if (!type.elementIsPointer && !matches(type.element, info.element, classes)) {
+				return false;
+			}
+			return (type.key == kNoType || matches(type.key, info.key, classes));
+		}
+	}
+
+	return false;
+}
+
+bool StreamSchema::matchesClass(uint32_t id, std::vector<uint32_t> &classes) const
+{
+	const Type &type = m_types[id];
+	const ReflectionData *local = type.local;
+	if (local->size() != type.size || (type.parent == kNoType) != (local->parent() == nullptr) ||
+		type.members.size() != local->members().size()) {
+		return false;
+	}
+
+	if (type.parent != kNoType && !matches(type.parent, local->parent(), classes)) {
+		return false;
+	}
+
+	for (size_t ii = 0; ii < type.members.size(); ++ii) {
+		const Member &member = type.members[ii];
+		const ReflectedMember *localMember = local->members()[ii];
+		if (member.name != localMember->name() || member.isPointer != localMember->isPointer() ||
+			member.count != elementCount(localMember)) {
+			return false;
+		}
+
+		if (member.isPointer) {
+			if (m_types[member.type].name != localMember->reflectionData()->name()) {
+				return false;
+			}
+		} else if (!matches(member.type, localMember->reflectionData(), classes)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool StreamSchema::compatible(uint32_t id, const ReflectionData *local) const
+{
+	if (local == nullptr) {
+		return false;
+	}
+
+	const Type &type = m_types[id];
+	switch (type.kind) {
+		case Kind::Primitive:
+			return (isPrimitive(local) && local->name() == type.name && local->size() == type.size &&
+					local->plan().ops.front().kind == type.encoding);
+
+		case Kind::Class:
+			return (!local->isContainer() && !isPrimitive(local) && local->name() == type.name);
+
+		case Kind::Container:
+		{
+			if (!local->isContainer()) {
+				return false;
+			}
+
+			const ContainerInfo &info = *local->container();
+			if (static_cast<uint8_t>(info.kind) != type.containerKind || info.elementIsPointer != type.elementIsPointer) {
+				return false;
+			}
+
+			// Arrays must keep their number of elements, even if the elements themselves changed.
+			if (info.kind == ContainerInfo::Kind::Array) {
+				uint64_t elementSize = type.elementIsPointer ? sizeof(void *) : m_types[type.element].size;
+				if (elementSize == 0 || (type.size / elementSize) != (local->size() / info.elementSize)) {
+					return false;
+				}
+			}
+
+			if (type.elementIsPointer) {
+				if (m_types[type.element].name != info.element->name()) {
+					return false;
+				}
+			} else if (!compatible(type.element, info.element)) {
+				return false;
+			}
+
+			if (type.key == kNoType) {
+				return (info.key == nullptr);
+			}
+			return compatible(type.key, info.key);
+		}
+	}
+
+	return false;
+}
+
+void StreamSchema::resolveContainer(uint32_t id, const ReflectionData *local)
+{
+	Type &type = m_types[id];
+	if (type.local != nullptr) {
+		return;
+	}
+
+	type.local = local;
+	const ContainerInfo &info = *local->container();
+	if (!type.elementIsPointer && m_types[type.element].kind == Kind::Container) {
+		resolveContainer(type.element, info.element);
+	}
+	if (type.key != kNoType && m_types[type.key].kind == Kind::Container) {
+		resolveContainer(type.key, info.key);
+	}
+
+	// Containers whose elements match are handed to the registered type as a whole.
+	std::vector<uint32_t> classes;
+	type.identical = matches(id, local, classes);
+	for (uint32_t dependency : classes) {
+		type.identical = (type.identical && m_types[dependency].identical);
+	}
+}
+
+void StreamSchema::buildRemap(uint32_t id)
+{
+	// Members of parents come first in the stream.
+	std::vector<uint32_t> chain;
+	for (uint32_t current = id; current != kNoType; current = m_types[current].parent) {
+		chain.push_back(current);
+	}
+
+	const ReflectionData *local = m_types[id].local;
+	std::vector<RemapEntry> remap;
+	for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+		for (auto &member : m_types[*it].members) {
+			RemapEntry entry;
+			entry.type = member.type;
+			entry.count = member.count;
+			entry.isPointer = member.isPointer;
+
+			const ReflectedMember *target = (local != nullptr) ? findMember(local, member.name) : nullptr;
+			if (target != nullptr && target->isPointer() == member.isPointer && elementCount(target) == member.count) {
+				const ReflectionData *targetType = target->reflectionData();
+				if (member.isPointer) {
+					if (m_types[member.type].name == targetType->name()) {
+						entry.target = target;
+					}
+				} else if (compatible(member.type, targetType)) {
+					entry.target = target;
+					if (m_types[member.type].kind == Kind::Container) {
+						resolveContainer(member.type, targetType);
+					}
+				}
+			}
+
+			remap.push_back(entry);
+		}
+	}
+
+	m_types[id].remap = std::move(remap);
+}
+
+void StreamSchema::decodeRecord(uint32_t id, ReflectedVariable &variable, BinaryRecordReader &record, PointerTable &pointerTable) const
+{
+	void *target = const_cast<void *>(variable.instanceData());
+	if (m_types[id].local == nullptr) {
+		target = nullptr;
+	}
+
+	if (m_types[id].kind == Kind::Class) {
+		registerNested(id, target, record, pointerTable);
+		decodePayload(id, target, record, pointerTable);
+	} else {
+		decodeValue(id, false, target, record, pointerTable);
+	}
+}
+
+void StreamSchema::registerNested(uint32_t id, void *target, BinaryRecordReader &record, PointerTable &pointerTable) const
+{
+	// Nested objects are listed depth-first, in the same order as SerializationPlan::objects.
+	for (auto &entry : m_types[id].remap) {
+		const Type &memberType = m_types[entry.type];
+		if (entry.isPointer || memberType.kind != Kind::Class) {
+			continue;
+		}
+
+		void *member = (target != nullptr && entry.target != nullptr) ? pointerOffset(target, entry.target->offset()) : nullptr;
+		for (uint64_t ii = 0; ii < entry.count; ++ii) {
+			void *element = (member != nullptr) ? pointerOffset(member, ii * memberType.local->size()) : nullptr;
+			if (!memberType.members.empty()) {
+				uint64_t index = record.subobjects.read<uint64_t>();
+				if (element != nullptr) {
+					pointerTable.setPointer(index, ReflectedVariable(memberType.local, element));
+				}
+			}
+			registerNested(entry.type, element, record, pointerTable);
+		}
+	}
+}
+
+void StreamSchema::decodePayload(uint32_t id, void *target, BinaryRecordReader &record, PointerTable &pointerTable) const
+{
+	for (auto &entry : m_types[id].remap) {
+		void *member = (target != nullptr && entry.target != nullptr) ? pointerOffset(target, entry.target->offset()) : nullptr;
+		if (entry.isPointer) {
+			decodeValue(entry.type, true, member, record, pointerTable);
+			continue;
+		}
+
+		size_t stride = (member != nullptr) ? m_types[entry.type].local->size() : 0;
+		for (uint64_t ii = 0; ii < entry.count; ++ii) {
+			decodeValue(entry.type, false, (member != nullptr) ? pointerOffset(member, ii * stride) : nullptr, record, pointerTable);
+		}
+	}
+}
+
+void StreamSchema::decodeValue(uint32_t id, bool isPointer, void *target, BinaryRecordReader &record, PointerTable &pointerTable) const
+{
+	const Type &type = m_types[id];
+	if (isPointer) {
+		uint64_t pointerIndex = record.payload.read<uint64_t>();
+		if (target != nullptr) {
+			ReflectedVariable pointerVariable(type.local, target);
+			pointerTable.addPatchPointer(pointerIndex, pointerVariable);
+		}
+		return;
+	}
+
+	switch (type.kind) {
+		case Kind::Primitive:
+			if (target != nullptr) {
+				type.local->deserializeElementBinary(target, false, record, pointerTable);
+				break;
+			}
+
+			switch (type.encoding) {
+				case SerializationPlan::Op::Kind::String:
+				case SerializationPlan::Op::Kind::StringView:
+					record.payload.skip(record.payload.read<uint64_t>());
+					break;
+
+				case SerializationPlan::Op::Kind::Custom:
+				{
+					// Only the type itself knows how much it wrote.
+					assert(type.local && "Skipped members with a custom encoding must still be registered");
+					void *scratch = type.local->allocateInstance();
+					type.local->deserializeElementBinary(scratch, false, record, pointerTable);
+					type.local->destroyInstance(scratch);
+					break;
+				}
+
+				default:
+					record.payload.skip(type.size);
+					break;
+			}
+			break;
+
+		case Kind::Class:
+			decodePayload(id, target, record, pointerTable);
+			break;
+
+		case Kind::Container:
+			decodeContainer(id, target, record, pointerTable);
+			break;
+	}
+}
+
+void StreamSchema::decodeElement(uint32_t id, bool isPointer, void *target, BinaryRecordReader &record, PointerTable &pointerTable) const
+{
+	const Type &type = m_types[id];
+	if (isPointer || type.kind != Kind::Class) {
+		decodeValue(id, isPointer, target, record, pointerTable);
+		return;
+	}
+
+	if (target != nullptr && type.identical) {
+		type.local->deserializeElementBinary(target, false, record, pointerTable);
+		return;
+	}
+
+	// Elements which are objects have their own table entry, followed by those of their nested objects.
+	if (!type.members.empty()) {
+		uint64_t index = record.subobjects.read<uint64_t>();
+		if (target != nullptr) {
+			pointerTable.setPointer(index, ReflectedVariable(type.local, target));
+		}
+	}
+	registerNested(id, target, record, pointerTable);
+	decodePayload(id, target, record, pointerTable);
+}
+
+void StreamSchema::decodeContainer(uint32_t id, void *target, BinaryRecordReader &record, PointerTable &pointerTable) const
+{
+	const Type &type = m_types[id];
+	if (target != nullptr && type.identical) {
+		type.local->deserializeContainerBinary(target, record, pointerTable);
+		return;
+	}
+
+	// Block copied elements are laid out exactly as if they had been written one by one.
+	size_t count = static_cast<size_t>(record.payload.read<uint64_t>());
+	const ContainerInfo *info = (target != nullptr) ? type.local->container() : nullptr;
+
+	if (type.containerKind == static_cast<uint8_t>(ContainerInfo::Kind::Map)) {
+		if (info != nullptr) {
+			info->clear(target);
+		}
+
+		for (size_t ii = 0; ii < count; ++ii) {
+			void *value = nullptr;
+			if (info != nullptr) {
+				value = info->insert(target, [&](void *key) { decodeElement(type.key, false, key, record, pointerTable); });
+			} else {
+				decodeElement(type.key, false, nullptr, record, pointerTable);
+			}
+			decodeElement(type.element, type.elementIsPointer, value, record, pointerTable);
+		}
+		return;
+	}
+
+	char *elements = nullptr;
+	if (info != nullptr) {
+		info->resize(target, count);
+		elements = static_cast<char *>(info->data(target));
+	}
+
+	for (size_t ii = 0; ii < count; ++ii) {
+		decodeElement(type.element, type.elementIsPointer, (elements != nullptr) ? elements + ii * info->elementSize : nullptr, record, pointerTable);
+	}
+}
+
+} // namespace carl
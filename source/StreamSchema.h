@@ -0,0 +1,220 @@
+//
+//  StreamSchema.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Layout of every type whose data appears in a binary stream, written to the stream header (see
+/// BinaryStream.h). The writer describes the record types along with everything their payloads are made
+/// of: parent types, member types, pointed to types and container elements.
+///
+/// The reader compares each type of the stream with the registered type of the same name once, when the
+/// header is read:
+///
+/// - Records of types whose layout matches the registered one are decoded with the regular binary path
+///   without any further lookups.
+/// - Every other class type gets a remap table which pairs each member of the stream type with the
+///   registered member of the same name (or an alias, see CARL_DECLARE_MEMBER_ALIAS). Members which were
+///   removed or whose type changed are skipped. Members which were added keep their default value.
+///
+/// Streams which need remapping are decoded on a single thread and their records are never used in place.
+///
+
+#include "SerializationPlan.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace carl {
+
+// Forward declarations.
+class ReflectionData;
+class ReflectedMember;
+class ReflectedVariable;
+class PointerTable;
+class BinaryWriter;
+class BinaryReader;
+struct BinaryRecordReader;
+
+class StreamSchema
+{
+public:
+
+    ///
+    /// Id written in place of a missing type (no parent, no map key).
+    ///
+    static constexpr uint32_t kNoType = 0xFFFFFFFF;
+
+    ///
+    /// Add a type and everything it is made of to the schema.
+    ///
+    /// @param type Type to add.
+    /// @return Id of the type within the stream.
+    ///
+    uint32_t add(const ReflectionData *type);
+
+    ///
+    /// Write the types of the schema in id order.
+    ///
+    /// @param writer Writer to append the types to.
+    /// @param firstId Id of the first type to write. Streamed tables write the types added since the last call.
+    ///
+    void write(BinaryWriter &writer, size_t firstId = 0) const;
+
+    ///
+    /// Read the types written by write() and match them against the registered types. Types are appended to
+    /// those read by earlier calls, so a schema written in parts can be read in the same parts.
+    ///
+    /// @param reader Reader covering exactly the types.
+    /// @param typeCount Number of types to read.
+    ///
+    void read(BinaryReader &reader, uint32_t typeCount);
+
+    ///
+    /// Get the number of types in the schema.
+    ///
+    /// @return Number of types.
+    ///
+    inline size_t size() const { return m_types.size(); }
+
+    ///
+    /// Get the registered type matching a type of the stream.
+    ///
+    /// @param id Id of the type within the stream.
+    /// @return Registered type with the same name, nullptr if there is none.
+    ///
+    inline const ReflectionData *localType(uint32_t id) const { return m_types[id].local; }
+
+    ///
+    /// Determine if a type of the stream has the same layout as the registered type.
+    ///
+    /// @param id Id of the type within the stream.
+    /// @return If true, records of this type can be decoded with the regular binary path.
+    ///
+    inline bool isIdentical(uint32_t id) const { return m_types[id].identical; }
+
+    ///
+    /// Determine if every type of the stream has the same layout as its registered type.
+    ///
+    /// @return If true, no record of the stream needs remapping.
+    ///
+    inline bool isIdentical() const { return m_identical; }
+
+    ///
+    /// Decode a record whose type doesn't match the registered type (see isIdentical()).
+    ///
+    /// @param id Id of the record's type within the stream.
+    /// @param variable Instance of the registered type to decode into.
+    /// @param record Record to read the member data and nested object indices from.
+    /// @param pointerTable Table to register nested objects and pointers to patch with.
+    ///
+    void decodeRecord(uint32_t id, ReflectedVariable &variable, BinaryRecordReader &record, PointerTable &pointerTable) const;
+
+private:
+
+    // Scanners walk streams with the layout of their types (see StreamScanner.h).
+    friend class StreamScanner;
+
+    enum class Kind : uint8_t
+    {
+        Primitive, ///< A type with its own binary functions (see ReflectionPrimitiveTypes.h).
+        Class,     ///< A reflected class.
+        Container  ///< A standard container (see ReflectionContainers.h).
+    };
+
+    ///
+    /// A member of a class type as written to the stream.
+    ///
+    struct Member
+    {
+        std::string name;              ///< Name of the member.
+        uint32_t    type = kNoType;    ///< Type of the member (the pointed to type for pointers).
+        uint64_t    count = 1;         ///< Number of elements (C arrays), always 1 for pointers.
+        bool        isPointer = false; ///< If true, the member is a pointer.
+    };
+
+    ///
+    /// A member of a class type (or one of its parents) paired with the registered member it is decoded into.
+    ///
+    struct RemapEntry
+    {
+        uint32_t               type = kNoType;    ///< Type of the member within the stream.
+        uint64_t               count = 1;         ///< Number of elements written.
+        bool                   isPointer = false; ///< If true, the member is a pointer.
+        const ReflectedMember *target = nullptr;  ///< Registered member to decode into, nullptr if the member is skipped.
+    };
+
+    ///
+    /// A type as written to the stream along with what it was matched to when read.
+    ///
+    struct Type
+    {
+        std::string name;
+        Kind        kind = Kind::Primitive;
+        uint64_t    size = 0;
+
+        SerializationPlan::Op::Kind encoding = SerializationPlan::Op::Kind::Bytes; ///< How a primitive is written.
+
+        uint32_t            parent = kNoType; ///< Parent of a class.
+        std::vector<Member> members;          ///< Members of a class, not including those of its parent.
+
+        uint8_t  containerKind = 0;        ///< ContainerInfo::Kind of a container.
+        uint32_t element = kNoType;        ///< Element type of a container.
+        uint32_t key = kNoType;            ///< Key type of a map.
+        bool     elementIsPointer = false; ///< If true, the elements of a container are pointers.
+
+        const ReflectionData   *local = nullptr;    ///< Registered type this type is decoded into.
+        bool                    identical = false;  ///< If true, the registered type has the same layout.
+        std::vector<RemapEntry> remap;              ///< Members of a class, parent members first.
+    };
+
+    ///
+    /// Determine if a stream type has exactly the layout of a registered type. Classes reached along the way
+    /// only have to be compatible, they are added to 'classes' as they must be identical as well.
+    ///
+    bool matches(uint32_t id, const ReflectionData *local, std::vector<uint32_t> &classes) const;
+
+    ///
+    /// Determine if the members of a stream class have exactly the layout of the members of its registered type.
+    ///
+    bool matchesClass(uint32_t id, std::vector<uint32_t> &classes) const;
+
+    ///
+    /// Determine if a stream type can be decoded into a registered type. Classes only need the same name.
+    ///
+    bool compatible(uint32_t id, const ReflectionData *local) const;
+
+    ///
+    /// Pair a stream container type with the registered container type it is decoded into.
+    ///
+    void resolveContainer(uint32_t id, const ReflectionData *local);
+
+    ///
+    /// Build the remap table of a class type.
+    ///
+    void buildRemap(uint32_t id);
+
+    ///
+    /// Decoding of the nested object indices, payload and container elements of a remapped type into the
+    /// registered type matched to 'id'. 'target' is nullptr for data which is skipped.
+    ///
+    void registerNested(uint32_t id, void *target, BinaryRecordReader &record, PointerTable &pointerTable) const;
+    void decodePayload(uint32_t id, void *target, BinaryRecordReader &record, PointerTable &pointerTable) const;
+    void decodeValue(uint32_t id, bool isPointer, void *target, BinaryRecordReader &record, PointerTable &pointerTable) const;
+    void decodeElement(uint32_t id, bool isPointer, void *target, BinaryRecordReader &record, PointerTable &pointerTable) const;
+    void decodeContainer(uint32_t id, void *target, BinaryRecordReader &record, PointerTable &pointerTable) const;
+
+    std::vector<Type>                                    m_types;            ///< Types in id order.
+    std::unordered_map<const ReflectionData *, uint32_t> m_ids;              ///< Id per type (writing only).
+    bool                                                 m_identical = true; ///< If true, every type matches its registered type.
+};
+
+} // namespace carl
@@ -0,0 +1,184 @@
+//
+//  StreamVisitor.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Interface driven by a StreamScanner with the contents of a binary stream. The scanner walks each
+/// record member by member and reports what it finds without creating any objects. Every name and
+/// value handed to a visitor points into the scanner's memory and is only valid during the call.
+///
+/// The events of a record nest like this:
+///
+///   beginRecord
+///     beginMember                   (parent members first, in the order they were written)
+///       value                       (primitives and pointers)
+///       beginObject ... endObject   (nested objects hold further members)
+///       beginContainer              (elements hold a value or an object, map elements hold
+///         beginElement ... endElement the key followed by the value)
+///       endContainer
+///     endMember
+///   endRecord
+///
+/// Runs of trivially copyable values (C arrays and containers of them) are reported as a single value
+/// holding every element. Other C arrays hold one element per entry. Records whose type is not a class
+/// (e.g. the target of an int pointer) hold a single value and no members.
+///
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <assert.h>
+
+namespace carl {
+
+// Forward declarations.
+class ReflectionData;
+class ReflectedMember;
+
+///
+/// A type as named in the stream.
+///
+struct StreamType
+{
+    std::string_view      name;            ///< Name of the type when the stream was written.
+    const ReflectionData *local = nullptr; ///< Registered type of the same name, nullptr if there is none (or it no longer matches).
+};
+
+///
+/// A record of the stream.
+///
+struct StreamRecord
+{
+    uint64_t   index = 0;      ///< Table index of the record.
+    StreamType type;           ///< Type of the record.
+    bool       isNull = false; ///< If true, the record stands for a null pointer and holds nothing.
+};
+
+///
+/// A member of a class as written to the stream.
+///
+struct StreamMember
+{
+    std::string_view       name;              ///< Name of the member when the stream was written.
+    StreamType             type;              ///< Type of the member (the pointed to type for pointers).
+    const ReflectedMember *local = nullptr;   ///< Registered member the value would be decoded into, nullptr if it would be skipped.
+    uint64_t               count = 1;         ///< Number of elements (C arrays).
+    bool                   isPointer = false; ///< If true, the member is a pointer.
+};
+
+///
+/// A single value.
+///
+struct StreamValue
+{
+    enum class Kind : uint8_t
+    {
+        Bytes,   ///< Raw bytes of a trivially copyable value, in native byte order.
+        String,  ///< Characters of a std::string or std::string_view.
+        Pointer, ///< Table index of the pointed to record.
+        Custom   ///< Encoded bytes of a type with its own binary functions, 'instance' holds it decoded.
+    };
+
+    Kind        kind = Kind::Bytes;
+    StreamType  type;                   ///< Type of the value (the pointed to type for pointers).
+    const char *data = nullptr;         ///< Bytes, characters or encoded bytes of the value (not for pointers).
+    size_t      size = 0;               ///< Number of bytes at 'data'.
+    uint64_t    count = 1;              ///< Number of consecutive values at 'data' (Bytes only).
+    uint64_t    pointerIndex = 0;       ///< Table index of the pointed to record (pointers only).
+    const void *instance = nullptr;     ///< Decoded value (Custom only), reused for the next value of the same type.
+
+    ///
+    /// Get a trivially copyable value.
+    ///
+    /// @param element Position of the value within a run.
+    ///
+    template<class T>
+    inline T as(uint64_t element = 0) const
+    {
+        assert(kind == Kind::Bytes && size == count * sizeof(T) && element < count);
+        T value;
+        memcpy(&value, data + element * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    ///
+    /// Get the characters of a string value.
+    ///
+    inline std::string_view string() const
+    {
+        assert(kind == Kind::String);
+        return std::string_view(data, size);
+    }
+};
+
+///
+/// Table index reported for nested objects which have no table entry of their own (classes made only of
+/// their parent's members).
+///
+constexpr uint64_t kNoStreamIndex = static_cast<uint64_t>(-1);
+
+class StreamVisitor
+{
+public:
+    virtual ~StreamVisitor() = default;
+
+    ///
+    /// A record begins.
+    ///
+    /// @param record Record being visited.
+    /// @return If false, the record is skipped by its length and endRecord() isn't called.
+    ///
+    virtual bool beginRecord(const StreamRecord & /*record*/) { return true; }
+    virtual void endRecord(const StreamRecord & /*record*/) {}
+
+    ///
+    /// A member of the current object begins.
+    ///
+    /// @param member Member being visited.
+    /// @return If false, nothing within the member is reported and endMember() isn't called.
+    ///
+    virtual bool beginMember(const StreamMember & /*member*/) { return true; }
+    virtual void endMember(const StreamMember & /*member*/) {}
+
+    ///
+    /// A nested object (a class member, array entry or container element) begins.
+    ///
+    /// @param type Type of the object.
+    /// @param index Table index of the object, which pointers to it refer to, or kNoStreamIndex.
+    ///
+    virtual void beginObject(const StreamType & /*type*/, uint64_t /*index*/) {}
+    virtual void endObject(const StreamType & /*type*/) {}
+
+    ///
+    /// A container begins.
+    ///
+    /// @param type Type of the container.
+    /// @param count Number of elements.
+    ///
+    virtual void beginContainer(const StreamType & /*type*/, uint64_t /*count*/) {}
+    virtual void endContainer(const StreamType & /*type*/) {}
+
+    ///
+    /// An element of a container or a C array begins.
+    ///
+    /// @param position Position of the element.
+    ///
+    virtual void beginElement(uint64_t /*position*/) {}
+    virtual void endElement(uint64_t /*position*/) {}
+
+    ///
+    /// A primitive value or a pointer.
+    ///
+    /// @param value Value found.
+    ///
+    virtual void value(const StreamValue & /*value*/) {}
+};
+
+} // namespace carl
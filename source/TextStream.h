@@ -0,0 +1,243 @@
+//
+//  TextStream.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Helpers for reading and writing values of the text serialization format. Numbers are
+/// converted with std::to_chars()/std::from_chars(), so they ignore the stream's locale and
+/// formatting flags and floating point values are written with the fewest digits that read
+/// back to exactly the same value.
+///
+/// Tokens are scanned directly in the characters the stream has buffered and parsed in place,
+/// only tokens which straddle the end of the buffer are gathered into a reusable scratch
+/// buffer first. Nothing is allocated once that buffer has grown to the longest such token.
+///
+
+#include <charconv>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+
+namespace carl {
+
+namespace text {
+
+///
+/// Longest number written by writeValue() (a double needs at most 24 characters).
+///
+constexpr size_t kMaxNumberLength = 32;
+
+///
+/// Determine if a character separates tokens. These are the characters isspace() accepts in the "C" locale.
+///
+inline bool isWhitespace(char character)
+{
+    return character == ' ' || static_cast<unsigned char>(character - '\t') < 5;
+}
+
+///
+/// Access to the characters a stream buffer holds in memory (the protected get area of std::streambuf).
+///
+class BufferAccess : public std::streambuf
+{
+public:
+    static inline const char *begin(std::streambuf *buffer) { return (buffer->*&BufferAccess::gptr)(); }
+    static inline const char *end(std::streambuf *buffer) { return (buffer->*&BufferAccess::egptr)(); }
+    static inline void advance(std::streambuf *buffer, size_t count) { (buffer->*&BufferAccess::gbump)(static_cast<int>(count)); }
+};
+
+///
+/// Skip whitespace up to the next token.
+///
+/// @param stream Stream to read from.
+/// @return False if the stream has failed or ends first, in which case its fail bit (and eof bit) is set.
+///
+inline bool skipWhitespace(std::istream &stream)
+{
+    if (!stream) {
+        stream.setstate(std::ios::failbit);
+        return false;
+    }
+
+    std::streambuf *buffer = stream.rdbuf();
+    while (true) {
+        const char *first = BufferAccess::begin(buffer);
+        const char *last = BufferAccess::end(buffer);
+        const char *position = first;
+        while (position != last && isWhitespace(*position)) {
+            ++position;
+        }
+        BufferAccess::advance(buffer, static_cast<size_t>(position - first));
+        if (position != last) {
+            return true;
+        }
+
+        // Everything buffered was whitespace, have the buffer refill itself.
+        std::streambuf::int_type next = buffer->sgetc();
+        if (std::streambuf::traits_type::eq_int_type(next, std::streambuf::traits_type::eof())) {
+            stream.setstate(std::ios::eofbit | std::ios::failbit);
+            return false;
+        }
+        if (!isWhitespace(std::streambuf::traits_type::to_char_type(next))) {
+            return true;
+        }
+        buffer->sbumpc();
+    }
+}
+
+///
+/// Find the next token and consume it from the stream.
+///
+/// @param stream Stream to read from.
+/// @param scratch Buffer the token is gathered into if it isn't entirely buffered by the stream.
+/// @param first Set to the first character of the token.
+/// @param last Set to one past the last character of the token. The token is only valid until the stream is next read.
+/// @return False if the stream ends before a token, in which case its eof and fail bits are set.
+///
+inline bool nextToken(std::istream &stream, std::string &scratch, const char *&first, const char *&last)
+{
+    if (!skipWhitespace(stream)) {
+        return false;
+    }
+
+    std::streambuf *buffer = stream.rdbuf();
+    const char *begin = BufferAccess::begin(buffer);
+    const char *end = BufferAccess::end(buffer);
+    const char *position = begin;
+    while (position != end && !isWhitespace(*position)) {
+        ++position;
+    }
+
+    if (position != end) {
+        BufferAccess::advance(buffer, static_cast<size_t>(position - begin));
+        first = begin;
+        last = position;
+        return true;
+    }
+
+    // The token runs past the buffered characters (or the buffer holds none), gather it a character at a time.
+    scratch.clear();
+    while (true) {
+        std::streambuf::int_type next = buffer->sgetc();
+        if (std::streambuf::traits_type::eq_int_type(next, std::streambuf::traits_type::eof())) {
+            stream.setstate(std::ios::eofbit);
+            break;
+        }
+
+        char character = std::streambuf::traits_type::to_char_type(next);
+        if (isWhitespace(character)) {
+            break;
+        }
+        scratch.push_back(character);
+        buffer->sbumpc();
+    }
+
+    first = scratch.data();
+    last = scratch.data() + scratch.size();
+    return true;
+}
+
+///
+/// Get the scratch buffer for tokens of the calling thread.
+///
+inline std::string &scratchBuffer()
+{
+    thread_local std::string scratch;
+    return scratch;
+}
+
+///
+/// Read the next whitespace separated token (the equivalent of 'stream >> token').
+///
+/// @param stream Stream to read from.
+/// @param token Set to the token. Its storage is reused.
+/// @return False if there is no token, in which case the stream's fail bit is set.
+///
+inline bool readToken(std::istream &stream, std::string &token)
+{
+    const char *first = nullptr;
+    const char *last = nullptr;
+    if (!nextToken(stream, scratchBuffer(), first, last)) {
+        return false;
+    }
+
+    token.assign(first, last);
+    return true;
+}
+
+///
+/// Read a value written with writeValue().
+///
+/// @param stream Stream to read from.
+/// @param value Set to the value.
+/// @return False if the next token is not a valid value, in which case the stream's fail bit is set.
+///
+template<class T>
+inline bool readValue(std::istream &stream, T &value)
+{
+    const char *first = nullptr;
+    const char *last = nullptr;
+    if (!nextToken(stream, scratchBuffer(), first, last)) {
+        return false;
+    }
+
+    if constexpr (std::is_same_v<T, bool>) {
+        if (last - first == 1 && (*first == '0' || *first == '1')) {
+            value = (*first == '1');
+            return true;
+        }
+    } else if constexpr (std::is_same_v<T, char>) {
+        // Characters are written as their code so that whitespace survives.
+        unsigned int code = 0;
+        std::from_chars_result result = std::from_chars(first, last, code);
+        if (result.ec == std::errc() && result.ptr == last && code <= 0xFF) {
+            value = static_cast<char>(static_cast<unsigned char>(code));
+            return true;
+        }
+    } else {
+        std::from_chars_result result = std::from_chars(first, last, value);
+        if (result.ec == std::errc() && result.ptr == last) {
+            return true;
+        }
+    }
+
+    stream.setstate(std::ios::failbit);
+    return false;
+}
+
+///
+/// Write a number (a character as its unsigned code, a bool as 0 or 1) followed by a separator.
+///
+/// @param stream Stream to write to.
+/// @param value Value to write.
+/// @param separator Character to write after the value.
+///
+template<class T>
+inline void writeValue(std::ostream &stream, T value, char separator)
+{
+    char buffer[kMaxNumberLength + 1];
+    char *end = buffer;
+    if constexpr (std::is_same_v<T, char>) {
+        end = std::to_chars(buffer, buffer + kMaxNumberLength, static_cast<unsigned int>(static_cast<unsigned char>(value))).ptr;
+    } else if constexpr (std::is_same_v<T, bool>) {
+        *end++ = value ? '1' : '0';
+    } else {
+        std::to_chars_result result = std::to_chars(buffer, buffer + kMaxNumberLength, value);
+        end = result.ptr;
+    }
+
+    *end++ = separator;
+    stream.write(buffer, end - buffer);
+}
+
+} // namespace text
+
+} // namespace carl
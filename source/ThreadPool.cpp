@@ -0,0 +1,147 @@
+//
+//  ThreadPool.cpp
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace carl {
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+	if (threadCount == 0) {
+		threadCount = std::thread::hardware_concurrency();
+	}
+	if (threadCount == 0) {
+		threadCount = 1;
+	}
+
+	for (size_t ii = 0; ii < threadCount; ++ii) {
+		m_queues.push_back(std::make_unique<Queue>());
+	}
+
+	// The calling thread takes part in running tasks so one less worker is needed.
+	for (size_t ii = 0; ii + 1 < threadCount; ++ii) {
+		m_threads.emplace_back(&ThreadPool::workerLoop, this, ii);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+
+	for (auto &thread : m_threads) {
+		thread.join();
+	}
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grainSize, const RangeFunction &function)
+{
+	if (count == 0) {
+		return;
+	}
+
+	if (grainSize == 0) {
+		// A few tasks per thread leaves room for stealing when ranges take uneven amounts of time.
+		size_t taskCount = threadCount() * 4;
+		grainSize = (count + taskCount - 1) / taskCount;
+	}
+
+	size_t taskCount = (count + grainSize - 1) / grainSize;
+	if (taskCount == 1 || threadCount() == 1) {
+		function(0, count);
+		return;
+	}
+
+	Batch batch;
+	batch.function = &function;
+	batch.remaining.store(taskCount, std::memory_order_relaxed);
+
+	// Count the tasks before queueing them so that the count never drops below zero when a task is taken early.
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_queuedTasks.fetch_add(taskCount, std::memory_order_relaxed);
+	}
+
+	// Deal the ranges out to the queues in contiguous runs so that each thread starts on neighbouring records.
+	// Owners take from the back of their queue, so ranges are pushed to the front to be run in ascending order.
+	size_t tasksPerQueue = (taskCount + m_queues.size() - 1) / m_queues.size();
+	for (size_t ii = 0; ii < taskCount; ++ii) {
+		Queue &queue = *m_queues[ii / tasksPerQueue];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_front({ &batch, ii * grainSize, std::min(count, (ii + 1) * grainSize) });
+	}
+	m_wake.notify_all();
+
+	// Help out until every task of this batch has finished.
+	size_t callerQueue = m_queues.size() - 1;
+	while (batch.remaining.load(std::memory_order_acquire) != 0) {
+		if (!runTask(callerQueue)) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool ThreadPool::runTask(size_t index)
+{
+	Task task;
+	bool found = false;
+
+	// Take the next task from our own queue first.
+	{
+		Queue &queue = *m_queues[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty()) {
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+			found = true;
+		}
+	}
+
+	// Otherwise steal the task furthest from the owner's current position in another queue.
+	for (size_t ii = 1; !found && ii < m_queues.size(); ++ii) {
+		Queue &queue = *m_queues[(index + ii) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty()) {
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+			found = true;
+		}
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+	(*task.batch->function)(task.begin, task.end);
+	task.batch->remaining.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+	while (true) {
+		if (runTask(index)) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_wake.wait(lock, [this] { return m_stop || m_queuedTasks.load(std::memory_order_relaxed) > 0; });
+		if (m_stop) {
+			return;
+		}
+	}
+}
+
+} // namespace carl
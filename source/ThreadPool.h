@@ -0,0 +1,114 @@
+//
+//  ThreadPool.h
+//  carl
+//
+//  Created by Cody White on 10/16/26.
+//  Copyright (c) 2022 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Small work-stealing thread pool used to process pointer table records in parallel.
+/// Every worker owns a queue of tasks: workers take tasks from the back of their own
+/// queue and, once it is empty, steal from the front of the other queues. The thread
+/// that submits work participates in running it until all of its tasks have finished.
+///
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace carl {
+
+class ThreadPool
+{
+public:
+
+    ///
+    /// Function run over a range of indices [begin, end).
+    ///
+    using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+    ///
+    /// @param threadCount Number of threads to use (including the calling thread), 0 to use one per hardware thread.
+    ///
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    // A pool owns its threads and is not copyable.
+    ThreadPool(const ThreadPool &other) = delete;
+    ThreadPool &operator=(const ThreadPool &other) = delete;
+
+    ///
+    /// Get the number of threads work is spread across (including the calling thread).
+    ///
+    /// @return Number of threads.
+    ///
+    inline size_t threadCount() const { return m_queues.size(); }
+
+    ///
+    /// Split [0, count) into ranges of at most 'grainSize' indices and run 'function' on each of them in parallel.
+    /// Returns once every range has been processed. Ranges may run in any order and on any thread.
+    ///
+    /// @param count Number of indices to process.
+    /// @param grainSize Maximum number of indices per range, 0 to pick one based on the number of threads.
+    /// @param function Function to run per range.
+    ///
+    void parallelFor(size_t count, size_t grainSize, const RangeFunction &function);
+
+private:
+
+    ///
+    /// Tasks submitted by a single call to parallelFor().
+    ///
+    struct Batch
+    {
+        const RangeFunction *function = nullptr; ///< Function to run for every task.
+        std::atomic<size_t>  remaining { 0 };    ///< Number of tasks which have not finished yet.
+    };
+
+    struct Task
+    {
+        Batch *batch = nullptr; ///< Batch the task belongs to.
+        size_t begin = 0;       ///< First index of the range.
+        size_t end = 0;         ///< One past the last index of the range.
+    };
+
+    struct Queue
+    {
+        std::mutex       mutex; ///< Guards tasks.
+        std::deque<Task> tasks; ///< Tasks owned by this queue.
+    };
+
+    ///
+    /// Run a single task, taken from the back of queue 'index' or stolen from the front of another queue.
+    ///
+    /// @param index Queue owned by the calling thread.
+    /// @return False if there was no task to run.
+    ///
+    bool runTask(size_t index);
+
+    ///
+    /// Main loop of each worker thread.
+    ///
+    /// @param index Queue owned by the worker.
+    ///
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;  ///< One queue per thread. The last queue belongs to the calling thread.
+    std::vector<std::thread>            m_threads; ///< Worker threads.
+
+    std::mutex              m_sleepMutex;     ///< Guards sleeping and waking workers.
+    std::condition_variable m_wake;           ///< Signalled when tasks are submitted or the pool is shutting down.
+    std::atomic<size_t>     m_queuedTasks{0}; ///< Number of tasks waiting in the queues.
+    bool                    m_stop = false;   ///< Set when the pool is being destroyed.
+};
+
+} // namespace carl